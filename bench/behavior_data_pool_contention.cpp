@@ -0,0 +1,102 @@
+// Contention microbenchmark for the behavior data pool allocator.
+// Every thread repeatedly allocates a handful of blocks (spread over all the
+// size classes) and destroys them again, so the free list heads are
+// hammered from all threads at once.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "pool_elem_key.h"
+#include "simulating_ifc.h"
+
+
+namespace
+{
+
+constexpr uint32_t k_num_iterations_per_thread{ 200000 };
+constexpr uint32_t k_num_held_blocks_per_thread{ 16 };
+constexpr uint32_t k_thread_counts[]{ 1, 2, 4, 8, 16, 32 };
+
+static_assert(k_num_held_blocks_per_thread * 32 <=
+              simulating::k_num_max_behavior_data_blocks * simulating::NUM_BEHAVIOR_DATA_SIZE_CLASSES);
+
+void run_allocator_thread(std::atomic_bool& start_flag, std::atomic_uint32_t& num_failures)
+{
+    pool::elem_key_t held_keys[k_num_held_blocks_per_thread];
+
+    while (!start_flag.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    for (uint32_t i = 0; i < k_num_iterations_per_thread; i += k_num_held_blocks_per_thread)
+    {
+        for (uint32_t j = 0; j < k_num_held_blocks_per_thread; j++)
+        {
+            auto& key{ held_keys[j] };
+            key = simulating::Behavior_data_w_version::allocate_one(
+                static_cast<simulating::Behavior_data_size_class>(
+                    j % simulating::NUM_BEHAVIOR_DATA_SIZE_CLASSES));
+            if (pool::is_invalid_key(key))
+            {
+                num_failures++;
+            }
+        }
+
+        for (auto key : held_keys)
+        {
+            if (!pool::is_invalid_key(key) &&
+                !simulating::Behavior_data_w_version::destroy_one(key))
+            {
+                num_failures++;
+            }
+        }
+    }
+}
+
+}  // namespace
+
+
+int main()
+{
+    simulating::Behavior_data_w_version::initialize_data_pool();
+
+    std::printf("threads,total_ops,seconds,mops_per_sec,failures\n");
+    for (uint32_t num_threads : k_thread_counts)
+    {
+        std::atomic_bool start_flag{ false };
+        std::atomic_uint32_t num_failures{ 0 };
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads);
+        for (uint32_t i = 0; i < num_threads; i++)
+        {
+            threads.emplace_back(run_allocator_thread,
+                                 std::ref(start_flag),
+                                 std::ref(num_failures));
+        }
+
+        auto start_time{ std::chrono::steady_clock::now() };
+        start_flag.store(true, std::memory_order_release);
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start_time };
+
+        // Allocate + destroy per iteration.
+        uint64_t total_ops{ 2ull * k_num_iterations_per_thread * num_threads };
+        std::printf("%u,%llu,%.4f,%.2f,%u\n",
+                    num_threads,
+                    static_cast<unsigned long long>(total_ops),
+                    elapsed.count(),
+                    total_ops / elapsed.count() / 1.0e6,
+                    num_failures.load());
+    }
+
+    return 0;
+}
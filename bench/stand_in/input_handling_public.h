@@ -0,0 +1,35 @@
+#pragma once
+
+// Stand-in for the engine input layer, for running the world simulation
+// headless in the benchmarks. Every gamepad reports the same scripted state.
+
+#include <cinttypes>
+#include <cmath>
+
+
+namespace input_handling
+{
+
+struct State_set
+{
+    struct Gameplay
+    {
+        float_t movement[2];
+        bool jump;
+    } gameplay;
+};
+
+inline State_set s_scripted_state_set{
+    .gameplay{
+        .movement{ 0.0f, 1.0f },
+        .jump{ false },
+    },
+};
+
+inline const State_set& get_state_set_reading_handle(uint32_t gamepad_idx)
+{
+    (void)gamepad_idx;
+    return s_scripted_state_set;
+}
+
+}  // namespace input_handling
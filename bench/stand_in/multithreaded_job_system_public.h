@@ -0,0 +1,51 @@
+#pragma once
+
+// Stand-in for the engine job system, for running the world simulation
+// headless in the benchmarks. Only the parts of the API that the world
+// simulation uses are provided.
+
+#include <atomic>
+#include <cinttypes>
+#include <vector>
+
+
+class Job_source;
+
+class Job_ifc
+{
+public:
+    Job_ifc(const char* name, Job_source& source)
+        : m_name(name)
+        , m_source(source)
+    {
+    }
+    virtual ~Job_ifc() = default;
+
+    virtual int32_t execute() = 0;
+
+    inline const char* get_name() const { return m_name; }
+    inline Job_source& get_source() { return m_source; }
+
+private:
+    const char* m_name;
+    Job_source& m_source;
+};
+
+class Job_source
+{
+public:
+    struct Job_next_jobs_return_data
+    {
+        std::vector<Job_ifc*> jobs;
+    };
+
+    virtual ~Job_source() = default;
+
+    virtual Job_next_jobs_return_data fetch_next_jobs_callback() = 0;
+
+private:
+    // Bookkeeping for `Stand_in_job_system`.
+    friend class Stand_in_job_system;
+    std::atomic_uint32_t m_num_outstanding_jobs{ 0 };
+    std::atomic_bool m_is_fetching{ false };
+};
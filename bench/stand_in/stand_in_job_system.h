@@ -0,0 +1,126 @@
+#pragma once
+
+// Stand-in worker pool that drives `Job_source`s the same way as the engine
+// job system: a source's `fetch_next_jobs_callback()` only gets called again
+// once all the jobs it handed out last time have finished.
+// @NOTE: The queue is a preallocated ring so that the job system itself
+//   doesn't show up in the allocation counts.
+
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "multithreaded_job_system_public.h"
+
+
+class Stand_in_job_system
+{
+public:
+    Stand_in_job_system(std::vector<Job_source*>&& sources)
+        : m_sources(std::move(sources))
+        , m_queue(k_queue_capacity, nullptr)
+    {
+    }
+
+    ~Stand_in_job_system()
+    {
+        stop();
+    }
+
+    void start(uint32_t num_threads)
+    {
+        assert(m_threads.empty());
+        m_stop = false;
+        m_threads.reserve(num_threads);
+        for (uint32_t i = 0; i < num_threads; i++)
+        {
+            m_threads.emplace_back(&Stand_in_job_system::thread_main, this);
+        }
+    }
+
+    void stop()
+    {
+        m_stop = true;
+        for (auto& thread : m_threads)
+        {
+            thread.join();
+        }
+        m_threads.clear();
+    }
+
+private:
+    std::vector<Job_source*> m_sources;
+    std::vector<std::thread> m_threads;
+    std::atomic_bool m_stop{ false };
+
+    static constexpr size_t k_queue_capacity{ 1 << 16 };
+    std::mutex m_queue_mutex;
+    std::vector<Job_ifc*> m_queue;
+    size_t m_queue_head{ 0 };
+    size_t m_queue_size{ 0 };
+
+    Job_ifc* try_pop_job()
+    {
+        std::lock_guard<std::mutex> lock{ m_queue_mutex };
+        if (m_queue_size == 0)
+        {
+            return nullptr;
+        }
+        Job_ifc* job{ m_queue[m_queue_head] };
+        m_queue_head = (m_queue_head + 1) % k_queue_capacity;
+        m_queue_size--;
+        return job;
+    }
+
+    bool try_fetch_jobs()
+    {
+        bool fetched_any{ false };
+        for (auto source : m_sources)
+        {
+            if (source->m_num_outstanding_jobs.load() != 0)
+            {
+                continue;
+            }
+
+            bool expected{ false };
+            if (!source->m_is_fetching.compare_exchange_strong(expected, true))
+            {
+                continue;
+            }
+
+            auto next_jobs{ source->fetch_next_jobs_callback() };
+            if (!next_jobs.jobs.empty())
+            {
+                source->m_num_outstanding_jobs = static_cast<uint32_t>(next_jobs.jobs.size());
+                std::lock_guard<std::mutex> lock{ m_queue_mutex };
+                assert(m_queue_size + next_jobs.jobs.size() <= k_queue_capacity);
+                for (auto job : next_jobs.jobs)
+                {
+                    m_queue[(m_queue_head + m_queue_size) % k_queue_capacity] = job;
+                    m_queue_size++;
+                }
+                fetched_any = true;
+            }
+
+            source->m_is_fetching = false;
+        }
+        return fetched_any;
+    }
+
+    void thread_main()
+    {
+        while (!m_stop)
+        {
+            if (Job_ifc* job = try_pop_job())
+            {
+                job->execute();
+                job->get_source().m_num_outstanding_jobs--;
+            }
+            else if (!try_fetch_jobs())
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
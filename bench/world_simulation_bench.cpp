@@ -0,0 +1,459 @@
+// Headless throughput benchmark for the world simulation.
+// Runs `World_simulation` unthrottled on the stand-in job system with a
+// scripted population of kinematic boxes and character controllers, spread
+// over a number of behavior groups, and reports ticks/second, the time each
+// tick phase took and the peak memory usage.
+// With `--check-allocs 1` (needs a `TICKING_WORLD_SIMULATION_COUNT_ALLOCATIONS`
+// build), exits with an error if the measured (steady-state) ticks allocated
+// (not counting the job lists handed to the job system, which it owns).
+//
+// Usage:
+//   ticking_world_simulation_bench [--kinematic N] [--characters M] [--groups K]
+//                                  [--ticks T] [--warmup-ticks W] [--threads J]
+//                                  [--wait-mode unthrottled|poll|sleep_spin]
+//                                  [--spin-us S] [--hz H] [--substeps S]
+//                                  [--max-catch-up C] [--batched 0|1]
+//                                  [--check-allocs 0|1] [--trace path.json]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "alloc_counter.h"
+#include "multithreaded_job_system_public.h"
+#include "physics_objects.h"
+#include "simulating_ifc.h"
+#include "stand_in_job_system.h"
+#include "standard_behaviors.h"
+#include "tick_pacer.h"
+#include "tick_profiler.h"
+#include "world_simulation.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif  // _WIN32
+
+
+namespace
+{
+
+struct Bench_params
+{
+    uint32_t num_kinematic{ 4096 };
+    uint32_t num_characters{ 512 };
+    uint32_t num_groups{ 64 };
+    uint64_t num_ticks{ 1000 };
+    uint64_t num_warmup_ticks{ 100 };
+    uint32_t num_threads{ std::max(2u, std::thread::hardware_concurrency()) };
+    world_sim::Tick_pacer::Wait_mode wait_mode{ world_sim::Tick_pacer::WAIT_MODE_UNTHROTTLED };
+    uint32_t spin_window_us{ 1500 };
+    uint32_t tick_hz{ 50 };
+    uint32_t physics_substeps{ 1 };
+    uint32_t max_catch_up_ticks{ 2 };
+    bool use_batched{ false };
+    bool check_allocs{ false };
+    const char* trace_path{ nullptr };
+};
+
+// Scripted driver for a kinematic box. Sways back and forth along x.
+class Bench_kinematic_mover : public simulating::Behavior_ifc
+{
+public:
+    Bench_kinematic_mover(uint32_t phase_offset)
+        : m_tick(phase_offset)
+    {
+    }
+
+    void set_output(
+        simulating::Behavior_data_key<std_behavior::Kinematic_collider_transform_input_data> output)
+    {
+        m_output = output;
+    }
+
+    void on_update() override
+    {
+        constexpr uint32_t k_sway_period_ticks{ 100 };
+        constexpr float_t k_sway_delta{ 0.02f };
+
+        std_behavior::Kinematic_collider_transform_input_data data;
+        data.type = std_behavior::TRANS_DATA_TYPE_MOVE_DELTA;
+        data.position = JPH::RVec3{
+            ((m_tick / (k_sway_period_ticks / 2)) % 2 == 0 ? k_sway_delta : -k_sway_delta),
+            0.0f,
+            0.0f };
+        data.rotation = JPH::Quat::sIdentity();
+        send_data_to_output<std_behavior::Kinematic_collider_transform_input_data>(
+            m_output, std::move(data));
+
+        m_tick++;
+    }
+
+private:
+    uint32_t m_tick;
+    simulating::Behavior_data_key<std_behavior::Kinematic_collider_transform_input_data> m_output;
+};
+
+// One behavior group worth of boxes and characters.
+// @NOTE: With `use_batched`, the kinematic colliders and humanoid movements
+//   go into the batched behavior storage instead of the group.
+class Bench_population_entity : public simulating::Entity_ifc
+{
+public:
+    Bench_population_entity(uint32_t group_idx,
+                            uint32_t num_kinematic,
+                            uint32_t num_characters,
+                            bool use_batched)
+        : m_group_idx(group_idx)
+        , m_num_kinematic(num_kinematic)
+        , m_num_characters(num_characters)
+        , m_use_batched(use_batched)
+    {
+    }
+
+    void on_create(simulating::Edit_behavior_groups_ifc& editor, entity_key_t entity_key) override
+    {
+        (void)entity_key;
+
+        // Lay the population out on a grid, one row per group, so that the
+        // bodies stay apart and the broad phase has real work to do.
+        constexpr float_t k_spacing{ 3.0f };
+        auto get_grid_position = [&](uint32_t i, float_t y) {
+            return JPH::RVec3{ i * k_spacing, y, m_group_idx * k_spacing };
+        };
+
+        std::vector<std::unique_ptr<simulating::Behavior_ifc>> group;
+        group.reserve(2 * m_num_kinematic + 3 * m_num_characters);
+        m_transform_holders.reserve(m_num_kinematic + m_num_characters);
+
+        // @NOTE: Transform holders follow their actor when it gets moved.
+        auto add_behavior = [&]<class T>(T&& behavior) {
+            if constexpr (simulating::Batched_behavior<T>)
+            {
+                if (m_use_batched)
+                {
+                    m_batched_behavior_keys.emplace_back(
+                        editor.add_batched_behavior(std::move(behavior)));
+                    return;
+                }
+            }
+            group.emplace_back(std::make_unique<T>(std::move(behavior)));
+        };
+
+        for (uint32_t i = 0; i < m_num_kinematic; i++)
+        {
+            phys_obj::Shape_params_box box_params{
+                .half_x{ 0.5f },
+                .half_y{ 0.5f },
+                .half_z{ 0.5f },
+            };
+            std::vector<phys_obj::Shape_w_transform> shapes;
+            shapes.emplace_back(phys_obj::Shape_w_transform{
+                .shape_type{ phys_obj::SHAPE_TYPE_BOX },
+                .shape_params{ &box_params },
+            });
+
+            std_behavior::Kinematic_collider collider{
+                phys_obj::Actor_kinematic{ get_grid_position(i, 0.0f),
+                                           JPH::Quat::sIdentity(),
+                                           std::move(shapes) } };
+            Bench_kinematic_mover mover{ i };
+            mover.set_output(
+                collider.get_data_key<std_behavior::Kinematic_collider_transform_input_data>());
+
+            m_transform_holders.emplace_back(
+                std::make_unique<phys_obj::Transform_holder>(
+                    true, collider.get_phys_kinematic_actor()));
+
+            add_behavior(std::move(mover));
+            add_behavior(std::move(collider));
+        }
+
+        for (uint32_t i = 0; i < m_num_characters; i++)
+        {
+            std_behavior::Humanoid_animator animator;
+            std_behavior::Humanoid_movement movement{
+                phys_obj::Actor_character_controller{
+                    get_grid_position(i, 10.0f),
+                    phys_obj::ACTOR_CC_TYPE_FRIENDLY_NPC,
+                    phys_obj::Shape_params_cylinder{
+                        .radius{ 0.5f },
+                        .half_height{ 1.0f },
+                    } } };
+            std_behavior::Gamepad_input_behavior gamepad;
+
+            movement.set_animator(
+                animator.get_data_key<std_behavior::Humanoid_animator_input_data>());
+            gamepad.set_output(
+                movement.get_data_key<std_behavior::Humanoid_movement_input_data>());
+
+            m_transform_holders.emplace_back(
+                std::make_unique<phys_obj::Transform_holder>(
+                    true, movement.get_phys_char_ctrl()));
+
+            add_behavior(std::move(gamepad));
+            add_behavior(std::move(movement));
+            add_behavior(std::move(animator));
+        }
+
+        m_group_key = editor.add_behavior_group(std::move(group));
+    }
+
+    void on_teardown(simulating::Edit_behavior_groups_ifc& editor) override
+    {
+        m_transform_holders.clear();
+        editor.remove_behavior_group(m_group_key);
+        for (auto key : m_batched_behavior_keys)
+        {
+            editor.remove_batched_behavior(key);
+        }
+        m_batched_behavior_keys.clear();
+    }
+
+private:
+    uint32_t m_group_idx;
+    uint32_t m_num_kinematic;
+    uint32_t m_num_characters;
+    bool m_use_batched;
+    std::vector<simulating::Batched_behavior_key> m_batched_behavior_keys;
+    simulating::Edit_behavior_groups_ifc::behavior_group_key_t m_group_key{ 0 };
+    std::vector<std::unique_ptr<phys_obj::Transform_holder>> m_transform_holders;
+};
+
+bool parse_args(int argc, char* argv[], Bench_params& out_params)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg{ argv[i] };
+        if (i + 1 >= argc)
+        {
+            std::cerr << "ERROR: Missing value for argument: " << arg << std::endl;
+            return false;
+        }
+        const char* value{ argv[++i] };
+
+        if (std::strcmp(arg, "--kinematic") == 0)
+            out_params.num_kinematic = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--characters") == 0)
+            out_params.num_characters = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--groups") == 0)
+            out_params.num_groups = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--ticks") == 0)
+            out_params.num_ticks = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--warmup-ticks") == 0)
+            out_params.num_warmup_ticks = std::strtoull(value, nullptr, 10);
+        else if (std::strcmp(arg, "--threads") == 0)
+            out_params.num_threads = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--wait-mode") == 0)
+        {
+            if (std::strcmp(value, "unthrottled") == 0)
+                out_params.wait_mode = world_sim::Tick_pacer::WAIT_MODE_UNTHROTTLED;
+            else if (std::strcmp(value, "poll") == 0)
+                out_params.wait_mode = world_sim::Tick_pacer::WAIT_MODE_POLL;
+            else if (std::strcmp(value, "sleep_spin") == 0)
+                out_params.wait_mode = world_sim::Tick_pacer::WAIT_MODE_SLEEP_SPIN;
+            else
+            {
+                std::cerr << "ERROR: Unknown wait mode: " << value << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(arg, "--spin-us") == 0)
+            out_params.spin_window_us = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--hz") == 0)
+            out_params.tick_hz = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--substeps") == 0)
+            out_params.physics_substeps = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--max-catch-up") == 0)
+            out_params.max_catch_up_ticks = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (std::strcmp(arg, "--batched") == 0)
+            out_params.use_batched = (std::strtoul(value, nullptr, 10) != 0);
+        else if (std::strcmp(arg, "--check-allocs") == 0)
+            out_params.check_allocs = (std::strtoul(value, nullptr, 10) != 0);
+        else if (std::strcmp(arg, "--trace") == 0)
+            out_params.trace_path = value;
+        else
+        {
+            std::cerr << "ERROR: Unknown argument: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (out_params.num_groups == 0 ||
+        out_params.num_threads == 0 ||
+        out_params.num_ticks == 0 ||
+        out_params.tick_hz == 0 ||
+        out_params.physics_substeps == 0)
+    {
+        std::cerr << "ERROR: --groups, --threads, --ticks, --hz and --substeps must be non-zero." << std::endl;
+        return false;
+    }
+
+    if (out_params.check_allocs && !HAWSOO_COUNT_ALLOCATIONS)
+    {
+        std::cerr << "ERROR: --check-allocs needs a build with TICKING_WORLD_SIMULATION_COUNT_ALLOCATIONS=ON." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t get_peak_memory_usage_bytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<size_t>(usage.ru_maxrss);  // Bytes.
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;  // Kilobytes.
+#endif  // __APPLE__
+#endif  // _WIN32
+}
+
+void wait_until_tick_count(const World_simulation& world_sim, uint64_t tick_count)
+{
+    while (world_sim.get_tick_count() < tick_count)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+}
+
+}  // namespace
+
+
+int main(int argc, char* argv[])
+{
+    Bench_params params;
+    if (!parse_args(argc, argv, params))
+    {
+        return 1;
+    }
+
+    std::atomic_size_t num_job_sources_setup_incomplete{ 1 };
+    auto world_simulation{
+        std::make_unique<World_simulation>(num_job_sources_setup_incomplete,
+                                           params.num_threads) };
+    auto& tick_pacer{ world_simulation->get_tick_pacer() };
+    tick_pacer.set_wait_mode(params.wait_mode);
+    tick_pacer.set_spin_window(std::chrono::microseconds(params.spin_window_us));
+    tick_pacer.set_tick_hz(params.tick_hz);
+    tick_pacer.set_physics_substeps(params.physics_substeps);
+    tick_pacer.set_max_catch_up_ticks(params.max_catch_up_ticks);
+
+    // Spread the population evenly over the groups.
+    for (uint32_t i = 0; i < params.num_groups; i++)
+    {
+        uint32_t num_kinematic{
+            params.num_kinematic / params.num_groups +
+                (i < params.num_kinematic % params.num_groups ? 1 : 0) };
+        uint32_t num_characters{
+            params.num_characters / params.num_groups +
+                (i < params.num_characters % params.num_groups ? 1 : 0) };
+        world_simulation->add_sim_entity_to_world(
+            std::make_unique<Bench_population_entity>(i,
+                                                      num_kinematic,
+                                                      num_characters,
+                                                      params.use_batched));
+    }
+
+    std::vector<Job_source*> job_sources{ world_simulation.get() };
+    if (auto physics_job_source = World_simulation::get_physics_job_source())
+    {
+        job_sources.emplace_back(physics_job_source);
+    }
+    Stand_in_job_system job_system{ std::move(job_sources) };
+
+    std::printf("kinematic=%u characters=%u groups=%u batched=%d threads=%u ticks=%llu warmup_ticks=%llu\n",
+                params.num_kinematic,
+                params.num_characters,
+                params.num_groups,
+                params.use_batched ? 1 : 0,
+                params.num_threads,
+                static_cast<unsigned long long>(params.num_ticks),
+                static_cast<unsigned long long>(params.num_warmup_ticks));
+
+    // Warm up (the population gets added at the end of the first tick).
+    // @NOTE: Record during the warmup too, so that the workers' profiler
+    //   rings get allocated before measuring.
+    tick_profiler::set_enabled(true);
+    job_system.start(params.num_threads);
+    wait_until_tick_count(*world_simulation, params.num_warmup_ticks + 1);
+
+    // Measure.
+    tick_profiler::clear();
+    tick_pacer.reset_stats();
+    uint64_t start_tick{ world_simulation->get_tick_count() };
+    uint64_t start_num_allocations{ alloc_counter::get_num_allocations() };
+    auto start_time{ std::chrono::steady_clock::now() };
+
+    wait_until_tick_count(*world_simulation, start_tick + params.num_ticks);
+
+    std::chrono::duration<double> elapsed{ std::chrono::steady_clock::now() - start_time };
+    uint64_t num_allocations{ alloc_counter::get_num_allocations() - start_num_allocations };
+    uint64_t num_ticks_run{ world_simulation->get_tick_count() - start_tick };
+    tick_profiler::set_enabled(false);
+    job_system.stop();
+
+    // Report.
+    std::printf("ticks=%llu seconds=%.4f ticks_per_sec=%.2f mean_tick_ms=%.4f\n",
+                static_cast<unsigned long long>(num_ticks_run),
+                elapsed.count(),
+                num_ticks_run / elapsed.count(),
+                elapsed.count() * 1000.0 / num_ticks_run);
+    std::printf("num_transforms=%zu peak_memory_mib=%.2f\n",
+                world_sim::Transform_store::get_num_transforms(),
+                get_peak_memory_usage_bytes() / (1024.0 * 1024.0));
+    auto shape_cache_stats{ phys_obj::get_shape_cache_stats() };
+    std::printf("shape_cache_hits=%llu shape_cache_misses=%llu cached_shapes=%zu cached_shape_kib=%.2f\n",
+                static_cast<unsigned long long>(shape_cache_stats.num_hits),
+                static_cast<unsigned long long>(shape_cache_stats.num_misses),
+                shape_cache_stats.num_cached_shapes,
+                (shape_cache_stats.num_shape_bytes + shape_cache_stats.num_key_bytes) / 1024.0);
+#if HAWSOO_COUNT_ALLOCATIONS
+    std::printf("allocations=%llu allocations_per_tick=%.4f\n",
+                static_cast<unsigned long long>(num_allocations),
+                static_cast<double>(num_allocations) / num_ticks_run);
+#endif  // HAWSOO_COUNT_ALLOCATIONS
+    tick_profiler::write_phase_stats(std::cout);
+    tick_pacer.write_stats(std::cout);
+
+    if (params.trace_path != nullptr)
+    {
+        std::ofstream trace_file{ params.trace_path };
+        tick_profiler::write_chrome_trace_json(trace_file);
+    }
+
+    int exit_code{ 0 };
+    if (params.check_allocs && num_allocations > 0)
+    {
+        std::cerr << "FAIL: The steady-state tick path allocated " << num_allocations
+                  << " times over " << num_ticks_run << " ticks." << std::endl;
+        exit_code = 1;
+    }
+
+    std::cout.flush();
+    std::fflush(stdout);
+
+    // @NOTE: The world simulation has no shutdown path yet (the physics world
+    //   and the bodies owned by the behaviors get torn down in no particular
+    //   order), so skip static/member destruction entirely.
+    std::_Exit(exit_code);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cinttypes>
+
+#ifndef HAWSOO_COUNT_ALLOCATIONS
+#define HAWSOO_COUNT_ALLOCATIONS 0
+#endif  // HAWSOO_COUNT_ALLOCATIONS
+
+
+namespace alloc_counter
+{
+
+// Number of global `operator new` calls so far (all threads), not counting
+// the exempt ones.
+// @NOTE: Always 0 unless built with `HAWSOO_COUNT_ALLOCATIONS` (CMake option
+//   `TICKING_WORLD_SIMULATION_COUNT_ALLOCATIONS`), which replaces the global
+//   `operator new`/`operator delete`.
+uint64_t get_num_allocations();
+
+// Allocations made by the calling thread inside this scope don't get counted.
+// @NOTE: Only for memory whose ownership leaves the world simulation, i.e.
+//   the job lists returned to the job system from `fetch_next_jobs_callback()`.
+class Scoped_exempt
+{
+public:
+    Scoped_exempt();
+    ~Scoped_exempt();
+
+    Scoped_exempt(const Scoped_exempt&)            = delete;
+    Scoped_exempt& operator=(const Scoped_exempt&) = delete;
+};
+
+}  // namespace alloc_counter
+
+#if HAWSOO_COUNT_ALLOCATIONS
+#define HAWSOO_ALLOC_COUNTER_CONCAT_INTERNAL(a, b) a##b
+#define HAWSOO_ALLOC_COUNTER_CONCAT(a, b) HAWSOO_ALLOC_COUNTER_CONCAT_INTERNAL(a, b)
+#define HAWSOO_ALLOC_COUNTER_EXEMPT_SCOPE()         \
+    alloc_counter::Scoped_exempt                    \
+        HAWSOO_ALLOC_COUNTER_CONCAT(_alloc_counter_exempt_, __LINE__)
+#else
+#define HAWSOO_ALLOC_COUNTER_EXEMPT_SCOPE()
+#endif  // HAWSOO_COUNT_ALLOCATIONS
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+
+namespace world_sim
+{
+
+// Lock-free multi-producer single-consumer queue.
+// @NOTE: Producers push onto an intrusive stack with a CAS loop and never
+//   block. The consumer takes the whole stack with one atomic exchange and
+//   reverses it, so items come out in the order they were pushed.
+template<class T>
+class Mpsc_queue
+{
+public:
+    Mpsc_queue() = default;
+    ~Mpsc_queue()
+    {
+        drain([](T&&) {});
+    }
+
+    Mpsc_queue(const Mpsc_queue&)            = delete;
+    Mpsc_queue(Mpsc_queue&&)                 = delete;
+    Mpsc_queue& operator=(const Mpsc_queue&) = delete;
+    Mpsc_queue& operator=(Mpsc_queue&&)      = delete;
+
+    // Any thread.
+    void push(T&& item)
+    {
+        Node* node{ new Node{ std::move(item), nullptr } };
+        node->next = m_head.load(std::memory_order_relaxed);
+        while (!m_head.compare_exchange_weak(node->next,
+                                             node,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed))
+        {
+            // `node->next` got reloaded with the current head.
+        }
+    }
+
+    // Consumer thread only. Calls `fn(T&&)` for every item pushed before the
+    // drain, oldest first. Returns the number of items.
+    template<class Fn>
+    size_t drain(Fn&& fn)
+    {
+        Node* node{ m_head.exchange(nullptr, std::memory_order_acquire) };
+
+        // Reverse into push order.
+        Node* reversed{ nullptr };
+        while (node != nullptr)
+        {
+            Node* next{ node->next };
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+
+        size_t num_items{ 0 };
+        while (reversed != nullptr)
+        {
+            Node* next{ reversed->next };
+            fn(std::move(reversed->item));
+            delete reversed;
+            reversed = next;
+            num_items++;
+        }
+        return num_items;
+    }
+
+private:
+    struct Node
+    {
+        T item;
+        Node* next;
+    };
+    std::atomic<Node*> m_head{ nullptr };
+};
+
+}  // namespace world_sim
@@ -5,18 +5,29 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <span>
 #include <utility>  // std::pair
 #include <vector>
 #include "cglm/cglm.h"
 #include "jolt_physics_headers.h"
 #include "transform_read_ifc.h"
+#include "transform_store.h"
 
 
 namespace phys_obj
 {
 
 // References.
-void set_references(void* physics_system, void* body_interface, void* job_system);
+// @NOTE: `num_threads` is the number of threads that can run physics jobs
+//   (sizes the contact event collection up front).
+void set_references(void* physics_system, void* body_interface, void* job_system, uint32_t num_threads);
+
+// Delta time of the current tick (for kinematic moves).
+void set_tick_delta_time(float_t delta_time);
+
+// Adds the bodies of all the actors created since the last call to the
+// physics world, as one batch. Called from the add pending objs stage.
+void add_pending_bodies();
 
 // Physics system deposits transforms here and renderer withdraws.
 using rvec3 = JPH::Real[3];
@@ -31,6 +42,7 @@ class Query_physics_transform_ifc
 {
 public:
     virtual Transform_decomposed query_physics_transform() const = 0;
+    virtual JPH::BodyID get_body_id() const = 0;
 };
 
 class Transform_holder : public world_sim::Transform_read_ifc
@@ -38,28 +50,118 @@ class Transform_holder : public world_sim::Transform_read_ifc
 public:
     Transform_holder(bool interpolate,
                      const Query_physics_transform_ifc& physics_transform_ref);
+    ~Transform_holder();
+
+    // Delete copy/move constructors (registered by address).
+    Transform_holder(const Transform_holder&)            = delete;
+    Transform_holder(Transform_holder&&)                 = delete;
+    Transform_holder& operator=(const Transform_holder&) = delete;
+    Transform_holder& operator=(Transform_holder&&)      = delete;
 
-    inline void set_interpolate(bool interpolate) { m_interpolate_transform = interpolate; }
+    void set_interpolate(bool interpolate);
+
+    // Re-points the holder after the actor it reads from got moved.
+    // @NOTE: Called by the actors' move constructors.
+    inline void set_physics_transform_ref(const Query_physics_transform_ifc& physics_transform_ref)
+    {
+        m_physics_transform_ref = &physics_transform_ref;
+    }
 
     void update_physics_transform();
     void read_current_transform(mat4& out_transform, float_t t) override;
 
-    inline static void increment_buffer_offset() { m_buffer_offset++; };
+    // Slot in `world_sim::Transform_store` (stable, matches the `out_slots`
+    // of `read_all_transforms()`).
+    inline uint32_t get_store_idx() const { return m_store_idx; }
+
+    inline static void increment_buffer_offset() { world_sim::Transform_store::increment_buffer_offset(); };
+
+    static constexpr size_t k_num_buffers{ 3 };
 
 private:
-    const Query_physics_transform_ifc& m_physics_transform_ref;
+    const Query_physics_transform_ifc* m_physics_transform_ref;
+    JPH::BodyID m_body_id;
+    uint32_t m_store_idx{ world_sim::Transform_store::k_invalid_idx };
+};
 
-    std::atomic_bool m_interpolate_transform;
+// Transform propagation.
+// @NOTE: Only the transform holders of bodies that moved get written each tick.
+//   Active bodies are tracked with the body activation listener, and bodies that
+//   fell asleep or got teleported keep getting written until all the buffers of
+//   the triple buffer are settled.
+void notify_body_activated(JPH::BodyID body_id);
+void notify_body_deactivated(JPH::BodyID body_id);
+void mark_body_moved(JPH::BodyID body_id);
+
+// Builds the list of transform holders to write this tick. Returns the list size.
+size_t collect_moved_transform_holders();
+// Writes the transform holders in range [begin, end) of the collected list.
+void update_moved_transform_holders(size_t begin, size_t end);
+
+// Contact events.
+// @NOTE: Jolt's contact callbacks run inside the parallel narrow phase, so
+//   they only append compact records to a buffer owned by the calling thread
+//   (no locks). After the step, the records get sorted by receiver and get
+//   delivered in batches from the dispatch stage. Contacts of bodies that
+//   aren't subscribed to the event type only cost a table lookup.
+enum Contact_event_type : uint8_t
+{
+    CONTACT_EVENT_ADDED = 0,
+    CONTACT_EVENT_PERSISTED,
+    CONTACT_EVENT_REMOVED,
+    NUM_CONTACT_EVENT_TYPES
+};
 
-    inline static std::atomic_size_t m_buffer_offset{ 0 };
-    static constexpr size_t k_read_a_offset{ 0 };
-    static constexpr size_t k_read_b_offset{ 1 };
-    static constexpr size_t k_write_offset{ 2 };
+using contact_event_flags_t = uint8_t;
+constexpr contact_event_flags_t k_contact_event_flag_added{ 1 << CONTACT_EVENT_ADDED };
+constexpr contact_event_flags_t k_contact_event_flag_persisted{ 1 << CONTACT_EVENT_PERSISTED };
+constexpr contact_event_flags_t k_contact_event_flag_removed{ 1 << CONTACT_EVENT_REMOVED };
 
-    static constexpr size_t k_num_buffers{ 3 };
-    std::array<Transform_decomposed, k_num_buffers> m_transform_triple_buffer;
+struct Contact_event
+{
+    JPH::BodyID body_id;  // Subscribed body.
+    JPH::BodyID other_body_id;
+    uint64_t other_user_data;
+    float_t normal[3];  // Points from `body_id` towards `other_body_id` (zero when removed).
+    float_t penetration_depth;
+    float_t approach_speed;  // Relative velocity along the normal (positive when closing in).
+    Contact_event_type type;
 };
 
+class Contact_receiver_ifc
+{
+public:
+    // Gets all of this tick's events of the receiver's bodies in one batch.
+    // @NOTE: Delivered after the trigger, hurtbox and scene queries of the
+    //   tick are done (asserted), so a receiver may move its own bodies
+    //   through the body interface. Batches of different receivers get
+    //   delivered in parallel though, so don't touch other receivers' bodies
+    //   and don't add or remove bodies here (leave that to the pending sim
+    //   object stages).
+    virtual void on_contact_events(std::span<const Contact_event> events) = 0;
+};
+
+// @NOTE: Don't (un)subscribe during the physics step. Actors unsubscribe
+//   their body when they get destroyed.
+void subscribe_contact_events(JPH::BodyID body_id,
+                              Contact_receiver_ifc& receiver,
+                              contact_event_flags_t flags);
+void unsubscribe_contact_events(JPH::BodyID body_id);
+
+// Contact listener side (physics step, any thread).
+void record_contact_event(Contact_event_type type,
+                          const JPH::Body& body1,
+                          const JPH::Body& body2,
+                          const JPH::ContactManifold& manifold);
+void record_contact_removed(const JPH::SubShapeIDPair& sub_shape_pair);
+
+// Sorts the events recorded during the step by receiver. Returns the number
+// of receivers that got events.
+// @NOTE: Single job after the step, can overlap with the world queries.
+size_t collect_contact_events();
+// Delivers the batches of the receivers in range [begin, end) of the collected list.
+void dispatch_contact_events(size_t begin, size_t end);
+
 // Shapes.
 enum Shape_type : uint32_t
 {
@@ -143,6 +245,29 @@ Shape_params_ptr construct_shape_into_memory(std::vector<uint32_t>& in_out_memor
 }
 
 
+// Shape cache.
+// @NOTE: Actors with identical shapes share the same shape instance.
+struct Shape_cache_stats
+{
+    uint64_t num_hits;
+    uint64_t num_misses;
+    size_t num_cached_shapes;
+    size_t num_shape_bytes;
+    size_t num_key_bytes;
+};
+Shape_cache_stats get_shape_cache_stats();
+
+// Drops the cached shapes that no actor is using anymore. Returns the number
+// of shapes dropped.
+size_t purge_unused_cached_shapes();
+
+// Gets the shared shape for these params (creates it on a cache miss).
+// @NOTE: Building the cache key allocates, so keep the returned ref around
+//   instead of calling this every tick.
+Shape_const_reference create_shape(Shape_type shape_type,
+                                   Shape_params_ptr shape_param);
+
+
 // Actors.
 struct Shape_w_transform
 {
@@ -164,8 +289,9 @@ public:
     Actor_kinematic& operator=(const Actor_kinematic&) = delete;
 
     // Define move constructors.
-    Actor_kinematic(Actor_kinematic&&)            = default;
-    Actor_kinematic& operator=(Actor_kinematic&&) = default;
+    // @NOTE: Moving re-points the transform holder of the body.
+    Actor_kinematic(Actor_kinematic&& other) noexcept;
+    Actor_kinematic& operator=(Actor_kinematic&& other) noexcept;
 
     ~Actor_kinematic();
 
@@ -175,6 +301,7 @@ public:
     void move_kinematic(JPH::RVec3Arg position, JPH::QuatArg rotation);
 
     Transform_decomposed query_physics_transform() const override;
+    JPH::BodyID get_body_id() const override { return m_body_id; }
 
 private:
     Shape_const_reference m_shape;
@@ -203,8 +330,9 @@ public:
     Actor_character_controller& operator=(const Actor_character_controller&) = delete;
 
     // Define move constructors.
-    Actor_character_controller(Actor_character_controller&&)            = default;
-    Actor_character_controller& operator=(Actor_character_controller&&) = default;
+    // @NOTE: Moving re-points the transform holder of the body.
+    Actor_character_controller(Actor_character_controller&& other) noexcept;
+    Actor_character_controller& operator=(Actor_character_controller&& other) noexcept;
 
     ~Actor_character_controller();
 
@@ -212,6 +340,7 @@ public:
     void move(JPH::Vec3Arg velocity);
 
     Transform_decomposed query_physics_transform() const override;
+    JPH::BodyID get_body_id() const override { return m_character_controller->GetBodyID(); }
 
 private:
     Actor_char_ctrller_type_e m_type;
@@ -222,35 +351,130 @@ private:
 
 // Trigger.
 // @NOTE: These interact with character controller actors to test if there is
-//   overlap with any actors and filters out unnecessary actors.
+//   overlap with any actors and filters out unnecessary actors. All triggers
+//   get evaluated once per tick after the physics step (in parallel batches),
+//   and the results stay valid until the next evaluation.
 class Trigger_kinematic
 {
 public:
-    Trigger_kinematic(Actor_char_ctrller_type_e sensing_type_flags, Shape_params_box&& volume_params);
+    Trigger_kinematic(JPH::RVec3 position,
+                      JPH::Quat rotation,
+                      Actor_char_ctrller_type_e sensing_type_flags,
+                      Shape_params_box&& volume_params);
+
+    // Delete copy constructors.
+    Trigger_kinematic(const Trigger_kinematic&)            = delete;
+    Trigger_kinematic& operator=(const Trigger_kinematic&) = delete;
+
+    // Define move constructors.
+    // @NOTE: Moving re-points the trigger's registry entry.
+    Trigger_kinematic(Trigger_kinematic&& other) noexcept;
+    Trigger_kinematic& operator=(Trigger_kinematic&& other) noexcept;
+
+    ~Trigger_kinematic();
 
     void set_sensing_type_flags(Actor_char_ctrller_type_e sensing_type_flags);
+    void set_transform(JPH::RVec3Arg position, JPH::QuatArg rotation);
 
-    inline bool get_is_triggered(
-        std::vector<Actor_character_controller*>& out_overlapping_actors)
-    {
-        out_overlapping_actors = m_overlapping_actors;
-        return m_is_triggered;
-    }
+    inline bool get_is_triggered() const { return !m_overlapping.empty(); }
+
+    // Body IDs of the sensed character controllers (sorted).
+    inline std::span<const JPH::BodyID> get_overlapping() const { return m_overlapping; }
+    inline std::span<const JPH::BodyID> get_entered() const { return m_entered; }
+    inline std::span<const JPH::BodyID> get_stayed() const { return m_stayed; }
+    inline std::span<const JPH::BodyID> get_exited() const { return m_exited; }
+
+    // Runs the overlap query and recalculates the deltas.
+    void update_overlaps();
 
 private:
+    void rebind_registry_entry();
+
     Actor_char_ctrller_type_e m_sensing_type_flags;
     Shape_const_reference m_trigger_volume;
-    bool m_is_triggered;
-    std::vector<Actor_character_controller*> m_overlapping_actors;
+    JPH::RVec3 m_position;
+    JPH::Quat m_rotation;
+    size_t m_registry_idx;
+
+    // @NOTE: Reserved to `k_max_trigger_overlaps` up front so updating never allocates.
+    std::vector<JPH::BodyID> m_overlapping;
+    std::vector<JPH::BodyID> m_prev_overlapping;
+    std::vector<JPH::BodyID> m_entered;
+    std::vector<JPH::BodyID> m_stayed;
+    std::vector<JPH::BodyID> m_exited;
 };
 
+// Returns the number of registered triggers.
+size_t get_num_triggers();
+// Updates the triggers in range [begin, end) of the registry.
+// @NOTE: Don't create or destroy triggers while this runs.
+void update_triggers(size_t begin, size_t end);
+
+
+// Scene queries.
+// @NOTE: Behaviors submit ray/shape casts during the logic update and read
+//   the results back by handle during the next tick's logic update. All of a
+//   tick's queries run in parallel batches after the physics step, instead
+//   of each behavior querying the physics system in the middle of its update.
+using scene_query_layer_flags_t = uint8_t;  // Bit per object layer.
+constexpr scene_query_layer_flags_t k_scene_query_layer_non_moving{ 1 << 0 };
+constexpr scene_query_layer_flags_t k_scene_query_layer_moving{ 1 << 1 };
+constexpr scene_query_layer_flags_t k_scene_query_layer_hit_hurt_box{ 1 << 2 };
+constexpr scene_query_layer_flags_t k_scene_query_layers_solid{
+    k_scene_query_layer_non_moving | k_scene_query_layer_moving };
+
+struct Scene_query_handle
+{
+    uint64_t tick;
+    uint32_t idx;
+
+    inline bool is_valid() const { return idx != (uint32_t)-1; }
+};
+constexpr Scene_query_handle k_invalid_scene_query_handle{ 0, (uint32_t)-1 };
+
+struct Scene_query_result
+{
+    bool has_hit;
+    JPH::BodyID body_id;
+    float_t fraction;  // Of the cast direction.
+    JPH::RVec3 position;
+    JPH::Vec3 normal;  // Points away from the hit body.
+};
+
+// `direction` includes the cast length. Thread safe (lock free).
+// @NOTE: Returns `k_invalid_scene_query_handle` if this tick's batch is full.
+Scene_query_handle submit_ray_cast(JPH::RVec3Arg origin,
+                                   JPH::Vec3Arg direction,
+                                   scene_query_layer_flags_t layers = k_scene_query_layers_solid,
+                                   JPH::BodyID ignore_body_id = JPH::BodyID());
+Scene_query_handle submit_shape_cast(const Shape_const_reference& shape,
+                                     JPH::RVec3Arg position,
+                                     JPH::QuatArg rotation,
+                                     JPH::Vec3Arg direction,
+                                     scene_query_layer_flags_t layers = k_scene_query_layers_solid,
+                                     JPH::BodyID ignore_body_id = JPH::BodyID());
+
+// Returns false if the results aren't available (still pending, or older
+// than the last batch).
+bool get_scene_query_result(Scene_query_handle handle, Scene_query_result& out_result);
+
+// Swaps the submitted queries into the batch to run. Returns the number of
+// queries in the batch.
+size_t collect_scene_queries();
+// Runs the queries in range [begin, end) of the collected batch.
+void run_scene_queries(size_t begin, size_t end);
+
 
 // Hitboxes.
+// @NOTE: Hitboxes are bodies in the `HIT_HURT_BOX` layer, which doesn't
+//   collide with anything. They only get found by the hurtbox queries of the
+//   combat stage (which runs after the physics step).
 class Hurtbox_ifc;  // Forward decl.
 
 enum Hurtbox_type_e : uint32_t
 {
     HURTBOX_TYPE_METAL_BLADE = 0,
+    HURTBOX_TYPE_HAZARD,
     NUM_HURTBOX_TYPES
 };
 
@@ -261,9 +485,26 @@ class Hitbox_ifc
 public:
     Hitbox_ifc(Hitbox_callback_fn&& callback);
 
+    // Delete copy and move constructors.
+    // @NOTE: The body's user data points at the hitbox.
+    Hitbox_ifc(const Hitbox_ifc&)            = delete;
+    Hitbox_ifc& operator=(const Hitbox_ifc&) = delete;
+    Hitbox_ifc(Hitbox_ifc&&)                 = delete;
+    Hitbox_ifc& operator=(Hitbox_ifc&&)      = delete;
+
+    virtual ~Hitbox_ifc();
+
     virtual void update_hitbox_transform() = 0;
     void report_hit(Hurtbox_ifc* hurtbox) { m_callback(hurtbox); }
 
+protected:
+    void create_hitbox_body(Shape_const_reference shape,
+                            JPH::RVec3Arg position,
+                            JPH::QuatArg rotation);
+
+    Shape_const_reference m_shape;
+    JPH::BodyID m_body_id;
+
 private:
     Hitbox_callback_fn m_callback;
 };
@@ -280,37 +521,184 @@ public:
 class Hitbox_kinematic : public Hitbox_ifc
 {
 public:
+    Hitbox_kinematic(JPH::RVec3 position,
+                     JPH::Quat rotation,
+                     Shape_params_box&& volume_params,
+                     Hitbox_callback_fn&& callback);
+
+    void set_transform(JPH::RVec3Arg position, JPH::QuatArg rotation);
     void update_hitbox_transform() override;
+
+private:
+    JPH::RVec3 m_position;
+    JPH::Quat m_rotation;
 };
 
 
 // Hurtboxes.
+// @NOTE: The combat stage finds the hitboxes near every active hurtbox with
+//   one broadphase pass over the hitbox layer, then each hurtbox runs its
+//   narrowphase queries against only those. A hitbox gets reported at most
+//   once per swing of a hurtbox (until `begin_swing()`). The hits get
+//   reported at the end of the combat stage.
 class Hurtbox_ifc
 {
 public:
     Hurtbox_ifc(Hurtbox_type_e type);
 
+    // Delete copy and move constructors.
+    // @NOTE: The combat stage keeps pointers to the hurtboxes.
+    Hurtbox_ifc(const Hurtbox_ifc&)            = delete;
+    Hurtbox_ifc& operator=(const Hurtbox_ifc&) = delete;
+    Hurtbox_ifc(Hurtbox_ifc&&)                 = delete;
+    Hurtbox_ifc& operator=(Hurtbox_ifc&&)      = delete;
+
+    virtual ~Hurtbox_ifc();
+
+    inline Hurtbox_type_e get_type() const { return m_type; }
+
+    virtual void set_active(bool active) { m_active = active; }
+    inline bool get_active() const { return m_active; }
+
+    // Forgets the hitboxes hit so far, so that they can get hit again.
+    virtual void begin_swing();
+
+    // Calculates `m_query_shape` and `m_query_transform` for this tick's query.
+    // @NOTE: Gets called from the combat stage (any thread).
     virtual void update_hurtbox_transform() = 0;
-    bool check_intersecting_hitboxes_and_report_hits();
+
+    // Combat stage.
+    void prepare_query();
+    inline const JPH::AABox& get_query_bounds() const { return m_query_bounds; }
+    // Indices into the hitboxes found by the broadphase pass.
+    inline void set_candidate_hitboxes(std::span<const uint32_t> hitbox_idxs)
+    {
+        m_candidate_hitbox_idxs = hitbox_idxs;
+    }
+    void query_intersecting_hitboxes();
+    void report_pending_hits();
+
+protected:
+    // Runs this tick's query. Defaults to overlapping `m_query_shape` at
+    // `m_query_transform`.
+    virtual void query_hitboxes();
+    // World space bounds of everything that `query_hitboxes()` touches.
+    // Defaults to the bounds of `m_query_shape` at `m_query_transform`.
+    virtual JPH::AABox calc_query_bounds() const;
+
+    void collide_hitboxes(const JPH::Shape* shape, JPH::RMat44Arg center_of_mass_transform);
+    void cast_hitboxes(const JPH::Shape* shape,
+                       JPH::RMat44Arg center_of_mass_start,
+                       JPH::Vec3Arg direction);
+
+    Shape_const_reference m_query_shape;
+    JPH::RMat44 m_query_transform{ JPH::RMat44::sIdentity() };  // Center of mass transform.
 
 private:
+    void add_pending_hit(Hitbox_ifc* hitbox);
+    bool is_hit_this_swing(Hitbox_ifc* hitbox) const;
+
     Hurtbox_type_e m_type;
+    bool m_active{ false };
+    size_t m_registry_idx;
+
+    JPH::AABox m_query_bounds;
+    std::span<const uint32_t> m_candidate_hitbox_idxs;
+
+    // @NOTE: Sorted. Reserved up front so that querying never allocates.
+    std::vector<Hitbox_ifc*> m_swing_hit_hitboxes;
+    std::vector<Hitbox_ifc*> m_pending_hits;
 };
 
+// Collects the active hurtboxes for this tick's combat stage. Returns the
+// number of active hurtboxes.
+size_t collect_active_hurtboxes();
+// Prepares the queries of the collected hurtboxes and pairs them with the
+// hitboxes that their bounds overlap, with one broadphase pass over the
+// hitbox layer (single job).
+void find_combat_candidates();
+// Queries the candidate hitboxes of the active hurtboxes in range
+// [begin, end) of the collected list (narrowphase).
+void query_active_hurtboxes(size_t begin, size_t end);
+// Reports the hits found by the queries (single thread, after all queries).
+void report_combat_hits();
+
 // @NOTE: Connects to a bone of the skeletal animator and calculates the delta orientations to find the way the blade traveled. Calculates a dynamic hurtbox from this.
+//   The swing between the previous and the current bone transform gets
+//   covered by a chain of capsule casts along interpolated bone transforms,
+//   with enough steps that no point of the blade moves more than one capsule
+//   radius per step. Swings that would take more than `k_max_sweep_steps`
+//   steps with the blade's capsule use a fatter capsule (fewer steps), so
+//   fast swings can't tunnel through hitboxes. All capsules are created once
+//   (and shared through the shape cache), so querying never allocates.
+//   Cost: up to `k_max_sweep_steps` narrowphase casts against each nearby
+//   hitbox per blade per tick.
 class Hurtbox_blade : public Hurtbox_ifc
 {
 public:
+    // `blade_base` and `blade_tip` are in bone space.
+    Hurtbox_blade(JPH::Vec3 blade_base, JPH::Vec3 blade_tip, float_t blade_radius);
+
+    // Call every tick with the bone's current world transform.
+    void set_bone_transform(JPH::RVec3Arg position, JPH::QuatArg rotation);
+
+    // Also restarts the sweep from the current bone transform.
+    void begin_swing() override;
+    // Deactivating also restarts the sweep (on the next activation).
+    void set_active(bool active) override;
+
     virtual void update_hurtbox_transform() override;
 
+protected:
+    void query_hitboxes() override;
+    JPH::AABox calc_query_bounds() const override;
+
+private:
+    struct Bone_transform
+    {
+        JPH::RVec3 position{ JPH::RVec3::sZero() };
+        JPH::Quat rotation{ JPH::Quat::sIdentity() };
+    };
+
+    static constexpr uint32_t k_max_sweep_steps{ 16 };
+    // Radius of each fat capsule is the blade's radius times 2, 4, 8...
+    static constexpr uint32_t k_num_fat_capsules{ 3 };
+
+    JPH::RMat44 calc_blade_transform(const Bone_transform& bone_transform) const;
+    Bone_transform calc_sweep_transform(float_t t) const;
+
+    JPH::Vec3 m_blade_center;  // Bone space.
+    JPH::Quat m_blade_rotation;  // Bone space. Capsule's Y axis along the blade.
+    JPH::Vec3 m_blade_base;
+    JPH::Vec3 m_blade_tip;
+    float_t m_blade_radius;
+    float_t m_blade_reach;  // Farthest point of the blade from the bone origin.
+    float_t m_blade_bound_radius;  // Bounds the blade's core segment around the bone origin.
+    std::array<Shape_const_reference, k_num_fat_capsules> m_fat_capsule_shapes;
+
+    Bone_transform m_bone_transform;
+    Bone_transform m_sweep_from;  // Bone transform at the end of the last sweep.
+    Bone_transform m_sweep_to;
+    bool m_has_sweep_from{ false };
+    const JPH::Shape* m_sweep_shape{ nullptr };
+    float_t m_sweep_radius{ 0.0f };
+    uint32_t m_num_sweep_steps{ 0 };  // 0 for a teleport.
 };
 
 // @NOTE: Essentially just a hazard.
 class Hurtbox_kinematic : public Hurtbox_ifc
 {
 public:
+    Hurtbox_kinematic(JPH::RVec3 position,
+                      JPH::Quat rotation,
+                      Shape_params_box&& volume_params);
+
+    void set_transform(JPH::RVec3Arg position, JPH::QuatArg rotation);
     virtual void update_hurtbox_transform() override;
 
+private:
+    JPH::RVec3 m_position;
+    JPH::Quat m_rotation;
 };
 
 }  // namespace phys_obj
@@ -4,6 +4,11 @@
 #include <atomic>
 #include <cassert>
 #include <cinttypes>
+#include <concepts>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
 #include <vector>
 #include "cglm/types.h"
 #include "jolt_physics_headers.h"
@@ -14,8 +19,33 @@ namespace simulating
 {
 
 class Behavior_ifc;
+class Behavior_batch_ifc;
+
+// Batched behaviors.
+// @NOTE: Opt-in alternative to behavior groups for behavior types with lots
+//   of instances. The type provides `static void update_batch(std::span<T>)`,
+//   all the instances of the type are stored contiguously, and the world
+//   simulation splits each type's array into chunks that run in parallel.
+//   Instances get moved around in memory (growth, swap-remove), so nothing
+//   may hold on to their address.
+template<class T>
+concept Batched_behavior =
+    std::derived_from<T, Behavior_ifc> &&
+    std::is_move_constructible_v<T> &&
+    std::is_move_assignable_v<T> &&
+    requires(std::span<T> behaviors) { T::update_batch(behaviors); };
+
+struct Batched_behavior_key
+{
+    uint32_t type_idx;
+    pool::elem_key_t elem_key;
+};
 
 // Interface for entities to edit behavior groups.
+// @NOTE: Only edit from `on_create()`/`on_teardown()` (tick boundary).
+//   Behavior group and batched behavior edits take effect at the start of
+//   the next logic update (a removed group or behavior gets destroyed then
+//   too).
 class Edit_behavior_groups_ifc
 {
 public:
@@ -23,18 +53,104 @@ public:
 
     virtual behavior_group_key_t add_behavior_group(std::vector<std::unique_ptr<Behavior_ifc>>&& group) = 0;
     virtual void remove_behavior_group(behavior_group_key_t group_key) = 0;
+
+    template<Batched_behavior T>
+    Batched_behavior_key add_batched_behavior(T&& behavior);
+    virtual void remove_batched_behavior(Batched_behavior_key key) = 0;
+
+protected:
+    using create_behavior_batch_fn_t = std::unique_ptr<Behavior_batch_ifc>(*)();
+
+    // Returns the batch of the type, creating it with `create_fn` if needed.
+    virtual Behavior_batch_ifc& get_behavior_batch(uint32_t type_idx,
+                                                   create_behavior_batch_fn_t create_fn) = 0;
 };
 
 // Abstract class for entities.
 class Entity_ifc
 {
 public:
+    using entity_key_t = pool::elem_key_t;
+
     // World simulation events.
-    virtual void on_create(Edit_behavior_groups_ifc& editor, size_t creation_idx) = 0;
+    // @NOTE: `entity_key` is the handle to pass into `remove_entity_from_world()`.
+    virtual void on_create(Edit_behavior_groups_ifc& editor, entity_key_t entity_key) = 0;
     virtual void on_teardown(Edit_behavior_groups_ifc& editor) = 0;
 };
 
-constexpr uint32_t k_num_max_behavior_data_blocks{ 4096 };
+// Behavior data size classes.
+// @NOTE: Each size class has its own slab of blocks. Blocks are 16 byte
+//   aligned so that SIMD types (e.g. `JPH::Quat`) load without penalty.
+enum Behavior_data_size_class : uint32_t
+{
+    BEHAVIOR_DATA_SIZE_CLASS_16 = 0,
+    BEHAVIOR_DATA_SIZE_CLASS_32,
+    BEHAVIOR_DATA_SIZE_CLASS_64,
+    BEHAVIOR_DATA_SIZE_CLASS_128,
+    BEHAVIOR_DATA_SIZE_CLASS_256,
+    NUM_BEHAVIOR_DATA_SIZE_CLASSES
+};
+
+constexpr uint32_t k_num_max_behavior_data_blocks{ 4096 };  // Per size class.
+constexpr size_t k_behavior_data_alignment{ 16 };
+constexpr size_t k_min_behavior_data_block_size{ 16 };
+constexpr size_t k_max_behavior_data_block_size{
+    k_min_behavior_data_block_size << (NUM_BEHAVIOR_DATA_SIZE_CLASSES - 1) };
+
+constexpr size_t get_size_class_block_size(Behavior_data_size_class size_class)
+{
+    return k_min_behavior_data_block_size << size_class;
+}
+
+template<class T>
+constexpr Behavior_data_size_class get_size_class()
+{
+    static_assert(sizeof(T) <= k_max_behavior_data_block_size);
+    static_assert(alignof(T) <= k_behavior_data_alignment);
+
+    uint32_t size_class{ 0 };
+    while (get_size_class_block_size(static_cast<Behavior_data_size_class>(size_class)) < sizeof(T))
+    {
+        size_class++;
+    }
+    return static_cast<Behavior_data_size_class>(size_class);
+}
+
+// Behavior data keys.
+// @NOTE: The size class is packed into the top bits of the index of the
+//   `pool::elem_key_t`.
+constexpr uint32_t k_behavior_data_size_class_shift{ 28 };
+constexpr uint32_t k_behavior_data_block_idx_mask{ (1u << k_behavior_data_size_class_shift) - 1 };
+
+inline Behavior_data_size_class get_key_size_class(pool::elem_key_t key)
+{
+    uint32_t idx, version_num;
+    pool::elem_key_extract_data(key, idx, version_num);
+    return static_cast<Behavior_data_size_class>(idx >> k_behavior_data_size_class_shift);
+}
+
+// Typed handle to a behavior data block.
+template<class T>
+class Behavior_data_key
+{
+public:
+    Behavior_data_key()
+        : m_key(pool::invalid_key())
+    {
+    }
+
+    explicit Behavior_data_key(pool::elem_key_t key)
+        : m_key(key)
+    {
+        assert(pool::is_invalid_key(key) || get_key_size_class(key) == get_size_class<T>());
+    }
+
+    inline pool::elem_key_t get() const { return m_key; }
+    inline bool is_valid() const { return !pool::is_invalid_key(m_key); }
+
+private:
+    pool::elem_key_t m_key;
+};
 
 class Behavior_data_w_version;
 
@@ -42,36 +158,31 @@ class Behavior_data_w_version;
 class Behavior_ifc
 {
 public:
-    Behavior_ifc();
+    Behavior_ifc();  // No input data.
+    Behavior_ifc(Behavior_data_size_class input_size_class);
     virtual ~Behavior_ifc();
 
+    // Delete copy constructors (owns its input data block).
+    Behavior_ifc(const Behavior_ifc&)            = delete;
+    Behavior_ifc& operator=(const Behavior_ifc&) = delete;
+
+    // Define move constructors (for batched behaviors).
+    Behavior_ifc(Behavior_ifc&& other) noexcept;
+    Behavior_ifc& operator=(Behavior_ifc&& other) noexcept;
+
     inline pool::elem_key_t get_data_key() { return m_input_data_key; }
 
     template<class T>
-    const T& get_data_from_input()
-    {
-        if (pool::is_invalid_key(m_input_data_key))
-        {
-            assert(false);
-        }
-
-        return
-            *reinterpret_cast<T*>(
-                Behavior_data_w_version::get_one_from_key(m_input_data_key)
-                    ->read_data());
-    }
+    inline Behavior_data_key<T> get_data_key() { return Behavior_data_key<T>(m_input_data_key); }
 
     template<class T>
-    void send_data_to_output(pool::elem_key_t output_key, T&& data)
-    {
-        if (pool::is_invalid_key(output_key))
-        {
-            assert(false);
-        }
+    const T& get_data_from_input();
 
-        Behavior_data_w_version::get_one_from_key(output_key)
-            ->write_data<T>(std::move(data));
-    }
+    // @NOTE: The consumer reads this next tick (behavior data is double
+    //   buffered per tick epoch), so behaviors run in no particular order
+    //   within a tick.
+    template<class T>
+    void send_data_to_output(Behavior_data_key<T> output_key, T&& data);
 
     virtual void on_update() = 0;
 
@@ -91,20 +202,28 @@ public:
     Behavior_data_w_version& operator=(Behavior_data_w_version&&)      = delete;
 
     static void initialize_data_pool();
-    static pool::elem_key_t allocate_one();
+    static pool::elem_key_t allocate_one(Behavior_data_size_class size_class);
     static bool destroy_one(pool::elem_key_t key);
     static Behavior_data_w_version* get_one_from_key(pool::elem_key_t key);
 
-    void* read_data()
+    // Tick epoch flip (call once at the tick boundary).
+    // @NOTE: Each block has a front and back buffer. Reads see the value that
+    //   was committed last tick, and writes go to the buffer for the next
+    //   tick, so behaviors can run in any order on any worker with
+    //   deterministic results. Only one behavior may write to a block per tick.
+    static void flip_tick_epoch();
+
+    const void* read_data()
     {
-        return reinterpret_cast<void*>(m_data);
+        return reinterpret_cast<const void*>(m_data + get_read_slot() * get_size_class_block_size(m_size_class));
     }
 
     template<class T>
     void write_data(T&& data)
     {
-        static_assert(sizeof(T) <= k_behavior_data_block_size);
-        *reinterpret_cast<T*>(m_data) = data;
+        static_assert(alignof(T) <= k_behavior_data_alignment);
+        assert(sizeof(T) <= get_size_class_block_size(m_size_class));
+        *reinterpret_cast<T*>(m_data + get_write_slot() * get_size_class_block_size(m_size_class)) = data;
     }
 
 private:
@@ -112,17 +231,261 @@ private:
     ~Behavior_data_w_version() = default;
 
     void reset(bool reset_all);
-    
-    static constexpr size_t k_behavior_data_block_size{ sizeof(float_t) * 3 };  // A vec3 (example benchmark data amount).
-    using Data_block = uint8_t[k_behavior_data_block_size];
 
-    Data_block m_data;
+    static bool is_valid_key(pool::elem_key_t key, Behavior_data_w_version*& out_block);
+
+    // Double buffering.
+    // @NOTE: `m_write_state` packs the epoch of the last write with the slot
+    //   that got written `(epoch << 1) | slot`. If the last write was in an
+    //   earlier epoch, it's committed and is the read slot. Otherwise the read
+    //   slot is the other one.
+    static constexpr uint32_t k_epoch_mask{ 0x7fffffff };
+    inline static std::atomic_uint32_t s_tick_epoch{ 1 };
+
+    uint32_t get_read_slot() const
+    {
+        uint32_t write_state{ m_write_state.load(std::memory_order_acquire) };
+        uint32_t slot{ write_state & 1 };
+        if ((write_state >> 1) == (s_tick_epoch.load(std::memory_order_relaxed) & k_epoch_mask))
+        {
+            // Written this tick. Read the committed slot.
+            slot ^= 1;
+        }
+        return slot;
+    }
+
+    uint32_t get_write_slot()
+    {
+        uint32_t epoch{ s_tick_epoch.load(std::memory_order_relaxed) & k_epoch_mask };
+        uint32_t write_state{ m_write_state.load(std::memory_order_relaxed) };
+        if ((write_state >> 1) != epoch)
+        {
+            // First write this tick. Write into the slot that isn't committed.
+            write_state = (epoch << 1) | ((write_state & 1) ^ 1);
+            m_write_state.store(write_state, std::memory_order_release);
+        }
+        return (write_state & 1);
+    }
+
+    // @NOTE: The data lives in the slab of the size class, separate from the
+    //   block metadata, so that the payloads are densely packed. Both buffers
+    //   of a block are next to each other.
+    uint8_t* m_data;
+    Behavior_data_size_class m_size_class;
     uint32_t m_version;
+    std::atomic_uint32_t m_write_state;
 
     static constexpr uint8_t k_unreserved{ 0 };
     static constexpr uint8_t k_setup_reservation{ 1 };
     static constexpr uint8_t k_reserved{ 2 };
     std::atomic_uint8_t m_reserved;
+
+    // Lock-free free list.
+    // @NOTE: The free list head is packed like a `pool::elem_key_t`, except the
+    //   version number is used as an ABA tag that gets bumped with every
+    //   successful push/pop.
+    static constexpr uint32_t k_no_free_idx{ (uint32_t)-1 };
+    std::atomic_uint32_t m_next_free_idx;
 };
 
+template<class T>
+const T& Behavior_ifc::get_data_from_input()
+{
+    if (pool::is_invalid_key(m_input_data_key))
+    {
+        assert(false);
+    }
+
+    assert(sizeof(T) <= get_size_class_block_size(get_key_size_class(m_input_data_key)));
+
+    return
+        *reinterpret_cast<const T*>(
+            Behavior_data_w_version::get_one_from_key(m_input_data_key)
+                ->read_data());
+}
+
+template<class T>
+void Behavior_ifc::send_data_to_output(Behavior_data_key<T> output_key, T&& data)
+{
+    if (!output_key.is_valid())
+    {
+        assert(false);
+    }
+
+    Behavior_data_w_version::get_one_from_key(output_key.get())
+        ->template write_data<T>(std::move(data));
+}
+
+// Batched behavior storage.
+class Behavior_batch_ifc
+{
+public:
+    virtual ~Behavior_batch_ifc() = default;
+
+    virtual size_t get_num_behaviors() = 0;
+    virtual void update_range(size_t begin, size_t end) = 0;
+    virtual bool remove(pool::elem_key_t key) = 0;
+
+    // Applies the adds and removes queued since the last call. Returns true
+    // if anything changed.
+    // @NOTE: Only call while no `update_range()` is running.
+    virtual bool apply_pending_edits() = 0;
+};
+
+inline std::atomic_uint32_t s_num_batched_behavior_types{ 0 };
+
+template<class T>
+uint32_t get_batched_behavior_type_idx()
+{
+    static const uint32_t s_type_idx{ s_num_batched_behavior_types++ };
+    return s_type_idx;
+}
+
+// Dense array of all the instances of a batched behavior type.
+// @NOTE: Keys stay valid while the instances get swap-removed, through the
+//   slot table (versioned like the entity pool).
+// @NOTE: Adds and removes only get queued (the key is handed out right away),
+//   so the dense array never changes under a running `update_range()`.
+template<Batched_behavior T>
+class Behavior_batch final : public Behavior_batch_ifc
+{
+public:
+    pool::elem_key_t add(T&& behavior)
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+
+        uint32_t slot_idx{ m_free_slot_head };
+        if (slot_idx == k_no_free_slot_idx)
+        {
+            slot_idx = static_cast<uint32_t>(m_slots.size());
+            m_slots.emplace_back();
+        }
+        else
+        {
+            m_free_slot_head = m_slots[slot_idx].next_free_idx;
+        }
+
+        auto& slot{ m_slots[slot_idx] };
+        slot.dense_idx = k_pending_dense_idx;
+        slot.version++;
+        slot.next_free_idx = k_no_free_slot_idx;
+        slot.pending_remove = false;
+
+        m_pending_adds.emplace_back(std::move(behavior));
+        m_pending_add_slot_idxs.emplace_back(slot_idx);
+        return pool::create_elem_key(slot_idx, slot.version);
+    }
+
+    bool remove(pool::elem_key_t key) override
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+
+        uint32_t slot_idx, version_num;
+        pool::elem_key_extract_data(key, slot_idx, version_num);
+        if (slot_idx >= m_slots.size() ||
+            m_slots[slot_idx].version != version_num ||
+            m_slots[slot_idx].dense_idx == k_no_free_slot_idx ||
+            m_slots[slot_idx].pending_remove)
+        {
+            // Stale key.
+            return false;
+        }
+
+        m_slots[slot_idx].pending_remove = true;
+        m_pending_remove_slot_idxs.emplace_back(slot_idx);
+        return true;
+    }
+
+    bool apply_pending_edits() override
+    {
+        std::lock_guard<std::mutex> lock{ m_mutex };
+
+        // @NOTE: Adds go first so that a behavior added and removed within
+        //   the same tick gets removed.
+        bool changed{ !m_pending_adds.empty() || !m_pending_remove_slot_idxs.empty() };
+        for (size_t i = 0; i < m_pending_adds.size(); i++)
+        {
+            uint32_t slot_idx{ m_pending_add_slot_idxs[i] };
+            m_slots[slot_idx].dense_idx = static_cast<uint32_t>(m_behaviors.size());
+            m_behaviors.emplace_back(std::move(m_pending_adds[i]));
+            m_dense_to_slot_idx.emplace_back(slot_idx);
+        }
+        m_pending_adds.clear();
+        m_pending_add_slot_idxs.clear();
+
+        for (uint32_t slot_idx : m_pending_remove_slot_idxs)
+        {
+            // Swap-remove.
+            uint32_t dense_idx{ m_slots[slot_idx].dense_idx };
+            uint32_t last_idx{ static_cast<uint32_t>(m_behaviors.size() - 1) };
+            if (dense_idx != last_idx)
+            {
+                m_behaviors[dense_idx] = std::move(m_behaviors[last_idx]);
+                m_dense_to_slot_idx[dense_idx] = m_dense_to_slot_idx[last_idx];
+                m_slots[m_dense_to_slot_idx[dense_idx]].dense_idx = dense_idx;
+            }
+            m_behaviors.pop_back();
+            m_dense_to_slot_idx.pop_back();
+
+            // Return slot to free list.
+            auto& slot{ m_slots[slot_idx] };
+            slot.dense_idx = k_no_free_slot_idx;
+            slot.next_free_idx = m_free_slot_head;
+            slot.pending_remove = false;
+            m_free_slot_head = slot_idx;
+        }
+        m_pending_remove_slot_idxs.clear();
+
+        return changed;
+    }
+
+    size_t get_num_behaviors() override
+    {
+        return m_behaviors.size();
+    }
+
+    void update_range(size_t begin, size_t end) override
+    {
+        assert(begin <= end && end <= m_behaviors.size());
+        T::update_batch(std::span<T>(m_behaviors.data() + begin, end - begin));
+    }
+
+private:
+    static constexpr uint32_t k_no_free_slot_idx{ (uint32_t)-1 };
+    static constexpr uint32_t k_pending_dense_idx{ (uint32_t)-2 };  // Added, waiting for `apply_pending_edits()`.
+    struct Slot
+    {
+        uint32_t dense_idx{ k_no_free_slot_idx };
+        uint32_t version{ 0 };
+        uint32_t next_free_idx{ k_no_free_slot_idx };
+        bool pending_remove{ false };
+    };
+
+    std::mutex m_mutex;
+    std::vector<T> m_behaviors;
+    std::vector<uint32_t> m_dense_to_slot_idx;
+    std::vector<Slot> m_slots;
+    uint32_t m_free_slot_head{ k_no_free_slot_idx };
+
+    // Queued edits.
+    std::vector<T> m_pending_adds;
+    std::vector<uint32_t> m_pending_add_slot_idxs;
+    std::vector<uint32_t> m_pending_remove_slot_idxs;
+};
+
+template<Batched_behavior T>
+Batched_behavior_key Edit_behavior_groups_ifc::add_batched_behavior(T&& behavior)
+{
+    uint32_t type_idx{ get_batched_behavior_type_idx<T>() };
+    auto& batch{
+        static_cast<Behavior_batch<T>&>(
+            get_behavior_batch(type_idx, []() -> std::unique_ptr<Behavior_batch_ifc> {
+                return std::make_unique<Behavior_batch<T>>();
+            })) };
+    return {
+        .type_idx{ type_idx },
+        .elem_key{ batch.add(std::move(behavior)) },
+    };
+}
+
 }  // namespace simulating
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include "cglm/cglm.h"
 #include "physics_objects.h"
 #include "simulating_ifc.h"
@@ -8,13 +9,15 @@
 namespace std_behavior
 {
 
+struct Humanoid_movement_input_data;
+
 class Gamepad_input_behavior
     : public simulating::Behavior_ifc
 {
 public:
     Gamepad_input_behavior();
 
-    void set_output(pool::elem_key_t output_humanoid_mvt);
+    void set_output(simulating::Behavior_data_key<Humanoid_movement_input_data> output_humanoid_mvt);
 
     void on_update() override;
 
@@ -22,7 +25,7 @@ private:
     uint32_t m_gamepad_idx;
     bool m_prev_jump;
 
-    pool::elem_key_t m_output_humanoid_mvt;
+    simulating::Behavior_data_key<Humanoid_movement_input_data> m_output_humanoid_mvt;
 };
 
 // Physics wrappers.
@@ -43,15 +46,20 @@ struct Kinematic_collider_transform_input_data
     JPH::Quat           rotation;
 };
 
-class Kinematic_collider
+class Kinematic_collider final
     : public simulating::Behavior_ifc
 {
 public:
     Kinematic_collider(phys_obj::Actor_kinematic&& phys_kinematic_actor);
 
     void on_update() override;
+    static void update_batch(std::span<Kinematic_collider> behaviors);
+
+    inline const phys_obj::Actor_kinematic& get_phys_kinematic_actor() const { return m_phys_kinematic_actor; }
 
 private:
+    void update();
+
     phys_obj::Actor_kinematic m_phys_kinematic_actor;
 };
 
@@ -62,20 +70,27 @@ struct Humanoid_movement_input_data
     bool release_jump;
 };
 
-class Humanoid_movement
+struct Humanoid_animator_input_data;
+
+class Humanoid_movement final
     : public simulating::Behavior_ifc
 {
 public:
     Humanoid_movement(
         phys_obj::Actor_character_controller&& phys_char_ctrl);
 
-    void set_animator(pool::elem_key_t output_animator_ctrl);
+    void set_animator(simulating::Behavior_data_key<Humanoid_animator_input_data> output_animator_ctrl);
 
     void on_update() override;
+    static void update_batch(std::span<Humanoid_movement> behaviors);
+
+    inline const phys_obj::Actor_character_controller& get_phys_char_ctrl() const { return m_phys_char_ctrl; }
 
 private:
+    void update();
+
     phys_obj::Actor_character_controller m_phys_char_ctrl;
-    pool::elem_key_t m_output_animator_ctrl;
+    simulating::Behavior_data_key<Humanoid_animator_input_data> m_output_animator_ctrl;
 };
 
 struct Humanoid_animator_input_data
@@ -99,6 +114,12 @@ class Humanoid_animator
     : public simulating::Behavior_ifc
 {
 public:
+    Humanoid_animator()
+        : simulating::Behavior_ifc(
+            simulating::get_size_class<Humanoid_animator_input_data>())
+    {
+    }
+
     void on_update() override {}  // @NOCHECKIN @WIP.
 };
 
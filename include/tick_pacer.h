@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+
+namespace world_sim
+{
+
+// Fixed timestep driver. Decides when the next world simulation tick starts.
+// @NOTE: Only the world simulation's job source calls `wait_for_next_tick()`
+//   (one fetch at a time), but the settings and stats can be accessed from
+//   any thread.
+// @NOTE: Tick deadlines are on a fixed grid (accumulator). Ticks that start
+//   late get caught up by running back to back, up to the max catch-up
+//   ticks. Anything further behind gets dropped so that an overloaded world
+//   doesn't spiral.
+class Tick_pacer
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+
+    enum Wait_mode : uint32_t
+    {
+        // Returns right away, and the job source gets polled again until the
+        // deadline passes. Cheapest on a client that has other jobs to run.
+        WAIT_MODE_POLL = 0,
+
+        // Parks the calling worker (OS sleep) until the spin window before
+        // the deadline, then spins the rest of the way inside the fetch.
+        // Holds that worker for the whole wait, so meant for headless
+        // servers where the world simulation is the main job source.
+        WAIT_MODE_SLEEP_SPIN,
+
+        // Starts the next tick right away (benchmarks).
+        WAIT_MODE_UNTHROTTLED,
+
+        NUM_WAIT_MODES
+    };
+
+    Tick_pacer(uint32_t tick_hz,
+               uint32_t physics_substeps,
+               uint32_t max_catch_up_ticks);
+
+    // Settings take effect from the next tick.
+    void set_tick_hz(uint32_t tick_hz);
+    void set_physics_substeps(uint32_t physics_substeps);
+    void set_max_catch_up_ticks(uint32_t max_catch_up_ticks);
+
+    // Settings of the current tick.
+    float_t get_tick_delta_time();
+    uint32_t get_physics_substeps();
+
+    void set_wait_mode(Wait_mode wait_mode);
+    Wait_mode get_wait_mode();
+
+    // Latency vs CPU trade-off for `WAIT_MODE_SLEEP_SPIN`. A longer spin
+    // window covers more of the OS sleep overshoot (smaller wake error) but
+    // burns more CPU per tick.
+    void set_spin_window(std::chrono::nanoseconds spin_window);
+
+    // Returns true if the next tick should start now.
+    bool wait_for_next_tick();
+
+    // Call once the current tick's transforms are published
+    // (`Transform_holder::increment_buffer_offset()`).
+    void mark_tick_published();
+
+    // Interpolation alpha for `Transform_holder::read_current_transform(t)`:
+    // how far wall time has advanced from the last published tick towards
+    // the next one, clamped to [0, 1]. Lock-free (render thread).
+    float_t get_interpolation_alpha() const;
+
+    struct Stats
+    {
+        uint64_t num_ticks;
+
+        // How late the ticks started compared to their deadline.
+        double wake_error_mean_us;
+        double wake_error_p50_us;
+        double wake_error_p99_us;
+        double wake_error_max_us;
+
+        // Ticks started back to back to catch up, and ticks skipped because
+        // the world fell further behind than the max catch-up ticks.
+        uint64_t num_catch_up_ticks;
+        uint64_t num_dropped_ticks;
+
+        // Standard deviation of the time between tick starts.
+        double tick_start_jitter_us;
+
+        // Fraction of the time spent waiting that the CPU was busy (spinning
+        // or getting polled) instead of sleeping.
+        double idle_cpu_busy_fraction;
+    };
+    Stats get_stats();
+    void write_stats(std::ostream& out);
+    void reset_stats();
+
+private:
+    std::mutex m_mutex;
+
+    Wait_mode m_wait_mode{ WAIT_MODE_POLL };
+    clock_t::duration m_tick_period;
+    uint32_t m_physics_substeps;
+    uint32_t m_max_catch_up_ticks;
+    clock_t::duration m_spin_window;
+    clock_t::time_point m_next_deadline;
+
+    // Current tick.
+    clock_t::time_point m_current_deadline;
+    clock_t::duration m_current_tick_period;
+    uint32_t m_current_physics_substeps;
+
+    // Last published tick (as `clock_t` ticks since epoch, for the render thread).
+    std::atomic<clock_t::rep> m_published_deadline{ 0 };
+    std::atomic<clock_t::rep> m_published_tick_period{ 0 };
+
+    // `WAIT_MODE_POLL` bookkeeping.
+    bool m_is_polling{ false };
+    clock_t::time_point m_first_poll_time;
+
+    // Stats.
+    static constexpr size_t k_num_samples{ 4096 };
+    std::vector<double> m_wake_error_samples_us;
+    std::vector<double> m_tick_interval_samples_us;
+    uint64_t m_num_ticks{ 0 };
+    uint64_t m_num_catch_up_ticks{ 0 };
+    uint64_t m_num_dropped_ticks{ 0 };
+    clock_t::time_point m_prev_tick_start;
+    clock_t::duration m_total_sleep_time{ 0 };
+    clock_t::duration m_total_busy_wait_time{ 0 };
+
+    static clock_t::duration get_tick_period(uint32_t tick_hz);
+
+    void record_tick_start(clock_t::time_point wait_begin,
+                           clock_t::time_point sleep_end,
+                           clock_t::time_point deadline,
+                           clock_t::time_point tick_start);
+};
+
+}  // namespace world_sim
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cinttypes>
+#include <ostream>
+
+#ifndef HAWSOO_ENABLE_TICK_PROFILER
+#define HAWSOO_ENABLE_TICK_PROFILER 1
+#endif  // HAWSOO_ENABLE_TICK_PROFILER
+
+
+namespace tick_profiler
+{
+
+// Phases of a world simulation tick.
+enum Phase : uint32_t
+{
+    PHASE_SCHEDULING = 0,  // `fetch_next_jobs_callback()`.
+    PHASE_LOGIC_UPDATE,
+    PHASE_STEP_PHYSICS,
+    PHASE_UPDATE_TRIGGERS,
+    PHASE_COMBAT,
+    PHASE_SCENE_QUERIES,
+    PHASE_DISPATCH_CONTACT_EVENTS,
+    PHASE_PROPAGATE_TRANSFORMS,
+    PHASE_REMOVE_PENDING_OBJS,
+    PHASE_ADD_PENDING_OBJS,
+    NUM_PHASES
+};
+
+const char* get_phase_name(Phase phase);
+
+// Recording is off until enabled.
+void set_enabled(bool enabled);
+bool is_enabled();
+
+// Tick number that new events get tagged with.
+void set_current_tick(uint64_t tick);
+
+// Drops all recorded events.
+void clear();
+
+// Records the begin/end timestamps of a scope into the ring buffer of the
+// calling thread.
+// @NOTE: `name` must be a string literal (only the pointer is stored).
+class Scoped_event
+{
+public:
+    Scoped_event(Phase phase, const char* name);
+    ~Scoped_event();
+
+    Scoped_event(const Scoped_event&)            = delete;
+    Scoped_event& operator=(const Scoped_event&) = delete;
+
+private:
+    Phase m_phase;
+    const char* m_name;
+    uint64_t m_begin_ns;
+    bool m_recording;
+};
+
+// Export.
+// @NOTE: Events that get recorded while exporting may show up torn, so
+//   export between ticks or after disabling recording.
+void write_chrome_trace_json(std::ostream& out);
+
+// Wall time a phase took per tick (first begin to last end of the phase's
+// events in that tick), over all the recorded ticks.
+struct Phase_stats
+{
+    uint64_t num_ticks;
+    double mean_us;
+    double p50_us;
+    double p99_us;
+    double max_us;
+};
+void compute_phase_stats(Phase_stats out_stats[NUM_PHASES]);
+void write_phase_stats(std::ostream& out);
+
+}  // namespace tick_profiler
+
+#if HAWSOO_ENABLE_TICK_PROFILER
+#define HAWSOO_TICK_PROFILER_CONCAT_INTERNAL(a, b) a##b
+#define HAWSOO_TICK_PROFILER_CONCAT(a, b) HAWSOO_TICK_PROFILER_CONCAT_INTERNAL(a, b)
+#define HAWSOO_TICK_PROFILER_SCOPE(phase, name)         \
+    tick_profiler::Scoped_event                         \
+        HAWSOO_TICK_PROFILER_CONCAT(_tick_prof_scope_, __LINE__){ phase, name }
+#else
+#define HAWSOO_TICK_PROFILER_SCOPE(phase, name)
+#endif  // HAWSOO_ENABLE_TICK_PROFILER
@@ -1,7 +1,11 @@
 #pragma once
 
+#include "alloc_counter.h"
 #include "physics_objects.h"
 #include "simulating_ifc.h"
 #include "standard_behaviors.h"
+#include "tick_pacer.h"
+#include "tick_profiler.h"
 #include "transform_read_ifc.h"
+#include "transform_store.h"
 #include "world_simulation.h"
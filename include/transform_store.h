@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cmath>
+#include "cglm/cglm.h"
+
+
+namespace world_sim
+{
+
+// Contiguous structure-of-arrays store of the triple buffered transforms.
+// Physics system deposits transforms here and renderer withdraws.
+// @NOTE: A transform keeps its slot for its whole lifetime, so writing never
+//   races with other transforms getting created or destroyed. Each buffer
+//   gets published with its own table of the live slots (in ascending
+//   order), which is what the lock-free reads go through. Freed slots only
+//   get reused once no published table holds them anymore.
+class Transform_store
+{
+public:
+    static constexpr uint32_t k_max_transforms{ 65536 };
+    static constexpr uint32_t k_invalid_idx{ (uint32_t)-1 };
+
+    // Returns the slot of the new transform (`k_invalid_idx` if out of slots).
+    static uint32_t allocate_one(bool interpolate,
+                                 const float_t position[3],
+                                 const versor rotation,
+                                 const vec3 scale);
+    static void destroy_one(uint32_t slot);
+
+    static void set_interpolate(uint32_t slot, bool interpolate);
+
+    // Writes the transform into the write buffer (the one not being read).
+    static void write_transform(uint32_t slot,
+                                const float_t position[3],
+                                const versor rotation,
+                                const vec3 scale);
+
+    // Publishes the write buffer along with the current live slots. Call
+    // once per tick after all writes (single thread).
+    static void increment_buffer_offset();
+
+    // Interpolates and composes the transform matrix of a single transform.
+    static void read_transform(uint32_t slot, float_t t, mat4& out_transform);
+
+    // Interpolates and composes the transform matrices of the first `count`
+    // published transforms into `out_transforms`. If `out_slots` isn't null,
+    // also writes the slot of each matrix into it (the stable mapping back to
+    // the owners). Returns the number of matrices written.
+    static size_t read_all_transforms(float_t t,
+                                      mat4* out_transforms,
+                                      size_t count,
+                                      uint32_t* out_slots = nullptr);
+
+    // Number of transforms in the latest published buffer.
+    static size_t get_num_transforms();
+
+private:
+    inline static std::atomic_size_t s_buffer_offset{ 0 };
+};
+
+}  // namespace world_sim
@@ -4,10 +4,13 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 #include "jolt_physics_headers.h"
+#include "mpsc_queue.h"
 #include "multithreaded_job_system_public.h"
 #include "simulating_ifc.h"
+#include "tick_pacer.h"
 
 
 class World_simulation : public Job_source, public simulating::Edit_behavior_groups_ifc
@@ -18,12 +21,31 @@ public:
     World_simulation(std::atomic_size_t& num_job_sources_setup_incomplete,
                      uint32_t num_threads);
 
+    using entity_key_t = simulating::Entity_ifc::entity_key_t;
+
     void add_sim_entity_to_world(std::unique_ptr<simulating::Entity_ifc>&& entity);
-    void remove_entity_from_world(size_t entity_idx);
+    void remove_entity_from_world(entity_key_t entity_key);
 
     behavior_group_key_t add_behavior_group(Behavior_group&& group) override;
     void remove_behavior_group(behavior_group_key_t group_key) override;
 
+    void remove_batched_behavior(simulating::Batched_behavior_key key) override;
+
+    // Job source that executes Jolt physics jobs on the engine's workers.
+    // Register it with the job system alongside the world simulation.
+    // @NOTE: Returns nullptr if the multithreaded physics job system is disabled.
+    static Job_source* get_physics_job_source();
+
+    // Decides when ticks start (wait mode, stats).
+    inline world_sim::Tick_pacer& get_tick_pacer() { return m_tick_pacer; }
+
+    // Number of ticks that have started their logic update.
+    inline uint64_t get_tick_count() const { return m_tick_count.load(std::memory_order_relaxed); }
+
+protected:
+    simulating::Behavior_batch_ifc& get_behavior_batch(uint32_t type_idx,
+                                                       create_behavior_batch_fn_t create_fn) override;
+
 private:
 
     std::atomic_size_t& m_num_job_sources_setup_incomplete;
@@ -34,7 +56,14 @@ private:
     //
     // - Main cycle.
     //   - Use timekeeper to find when next tick starts.
-    //   - Execute simulation ticks (multiple jobs per available object).
+    //   - Execute simulation ticks (cost-balanced chunks of behaviors and
+    //     chunks of the batched behaviors).
+    //   - Step physics world (single job).
+    //   - Update triggers (chunks of triggers), query hurtboxes (chunks of
+    //     hurtboxes) and run scene queries (chunks of queries).
+    //   - Report combat hits (single job).
+    //   - Dispatch contact events (chunks of receivers).
+    //   - Propagate transforms.
     //   - Remove pending delete objects.
     //   - Add pending addition objects.
     //   - Check if should shut down.
@@ -64,20 +93,27 @@ private:
         J2_execute_simulation_tick_job(World_simulation& world_sim)
             : Job_ifc("World Simulation execute sim tick job", world_sim)
             , m_world_sim(world_sim)
-            , m_group_ptr(nullptr)
+            , m_begin(0)
+            , m_end(0)
+            , m_measure_costs(false)
         {
         }
 
-        void set_behavior_group(Behavior_group* group_ptr)
+        // Range of `m_behavior_schedule_nodes`.
+        void set_range(size_t begin, size_t end, bool measure_costs)
         {
-            m_group_ptr = group_ptr;
+            m_begin = begin;
+            m_end = end;
+            m_measure_costs = measure_costs;
         }
 
         int32_t execute() override;
 
     private:
         World_simulation& m_world_sim;
-        Behavior_group* m_group_ptr;
+        size_t m_begin;
+        size_t m_end;
+        bool m_measure_costs;
     };
     std::vector<std::unique_ptr<J2_execute_simulation_tick_job>> m_j2_execute_simulation_tick_jobs;
 
@@ -111,6 +147,233 @@ private:
     };
     std::unique_ptr<J4_add_pending_objs_job> m_j4_add_pending_objs_job;
 
+    class J5_step_physics_world_job : public Job_ifc
+    {
+    public:
+        J5_step_physics_world_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation step physics world job", world_sim)
+            , m_world_sim(world_sim)
+        {
+        }
+
+        int32_t execute() override;
+
+        World_simulation& m_world_sim;
+    };
+    std::unique_ptr<J5_step_physics_world_job> m_j5_step_physics_world_job;
+
+    class J6_propagate_transforms_job : public Job_ifc
+    {
+    public:
+        J6_propagate_transforms_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation propagate transforms job", world_sim)
+            , m_begin(0)
+            , m_end(0)
+        {
+        }
+
+        void set_range(size_t begin, size_t end)
+        {
+            m_begin = begin;
+            m_end = end;
+        }
+
+        int32_t execute() override;
+
+    private:
+        size_t m_begin;
+        size_t m_end;
+    };
+    std::vector<std::unique_ptr<J6_propagate_transforms_job>> m_j6_propagate_transforms_jobs;
+    static constexpr size_t k_transform_propagation_batch_size{ 256 };
+
+    class J7_execute_behavior_batch_job : public Job_ifc
+    {
+    public:
+        J7_execute_behavior_batch_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation execute behavior batch job", world_sim)
+            , m_batch_ptr(nullptr)
+            , m_begin(0)
+            , m_end(0)
+        {
+        }
+
+        void set_range(simulating::Behavior_batch_ifc* batch_ptr, size_t begin, size_t end)
+        {
+            m_batch_ptr = batch_ptr;
+            m_begin = begin;
+            m_end = end;
+        }
+
+        int32_t execute() override;
+
+    private:
+        simulating::Behavior_batch_ifc* m_batch_ptr;
+        size_t m_begin;
+        size_t m_end;
+    };
+    std::vector<std::unique_ptr<J7_execute_behavior_batch_job>> m_j7_execute_behavior_batch_jobs;
+    static constexpr size_t k_behavior_batch_chunk_size{ 256 };
+
+    class J8_dispatch_contact_events_job : public Job_ifc
+    {
+    public:
+        J8_dispatch_contact_events_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation dispatch contact events job", world_sim)
+            , m_begin(0)
+            , m_end(0)
+        {
+        }
+
+        void set_range(size_t begin, size_t end)
+        {
+            m_begin = begin;
+            m_end = end;
+        }
+
+        int32_t execute() override;
+
+    private:
+        size_t m_begin;
+        size_t m_end;
+    };
+    std::vector<std::unique_ptr<J8_dispatch_contact_events_job>> m_j8_dispatch_contact_events_jobs;
+    static constexpr size_t k_contact_dispatch_batch_size{ 64 };  // Min receivers per job.
+
+    class J9_update_triggers_job : public Job_ifc
+    {
+    public:
+        J9_update_triggers_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation update triggers job", world_sim)
+            , m_begin(0)
+            , m_end(0)
+        {
+        }
+
+        void set_range(size_t begin, size_t end)
+        {
+            m_begin = begin;
+            m_end = end;
+        }
+
+        int32_t execute() override;
+
+    private:
+        size_t m_begin;
+        size_t m_end;
+    };
+    std::vector<std::unique_ptr<J9_update_triggers_job>> m_j9_update_triggers_jobs;
+    static constexpr size_t k_trigger_update_batch_size{ 16 };  // Min triggers per job.
+
+    class J10_query_hurtboxes_job : public Job_ifc
+    {
+    public:
+        J10_query_hurtboxes_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation query hurtboxes job", world_sim)
+            , m_begin(0)
+            , m_end(0)
+        {
+        }
+
+        void set_range(size_t begin, size_t end)
+        {
+            m_begin = begin;
+            m_end = end;
+        }
+
+        int32_t execute() override;
+
+    private:
+        size_t m_begin;
+        size_t m_end;
+    };
+    std::vector<std::unique_ptr<J10_query_hurtboxes_job>> m_j10_query_hurtboxes_jobs;
+    static constexpr size_t k_hurtbox_query_batch_size{ 16 };  // Min hurtboxes per job.
+    size_t m_num_active_hurtboxes{ 0 };
+
+    class J11_report_combat_hits_job : public Job_ifc
+    {
+    public:
+        J11_report_combat_hits_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation report combat hits job", world_sim)
+        {
+        }
+
+        int32_t execute() override;
+    };
+    std::unique_ptr<J11_report_combat_hits_job> m_j11_report_combat_hits_job;
+
+    class J12_run_scene_queries_job : public Job_ifc
+    {
+    public:
+        J12_run_scene_queries_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation run scene queries job", world_sim)
+            , m_begin(0)
+            , m_end(0)
+        {
+        }
+
+        void set_range(size_t begin, size_t end)
+        {
+            m_begin = begin;
+            m_end = end;
+        }
+
+        int32_t execute() override;
+
+    private:
+        size_t m_begin;
+        size_t m_end;
+    };
+    std::vector<std::unique_ptr<J12_run_scene_queries_job>> m_j12_run_scene_queries_jobs;
+    static constexpr size_t k_scene_query_batch_size{ 64 };  // Min queries per job.
+
+    class J13_collect_contact_events_job : public Job_ifc
+    {
+    public:
+        J13_collect_contact_events_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation collect contact events job", world_sim)
+            , m_world_sim(world_sim)
+        {
+        }
+
+        int32_t execute() override;
+
+        World_simulation& m_world_sim;
+    };
+    std::unique_ptr<J13_collect_contact_events_job> m_j13_collect_contact_events_job;
+    size_t m_num_contact_receivers{ 0 };
+
+    class J14_find_combat_candidates_job : public Job_ifc
+    {
+    public:
+        J14_find_combat_candidates_job(World_simulation& world_sim)
+            : Job_ifc("World Simulation find combat candidates job", world_sim)
+        {
+        }
+
+        int32_t execute() override;
+    };
+    std::unique_ptr<J14_find_combat_candidates_job> m_j14_find_combat_candidates_job;
+
+    // Job pools of the parallel stages.
+    // @NOTE: Created up front (`m_num_threads * k_range_jobs_per_thread` jobs
+    //   per stage) so that the tick doesn't allocate when the population
+    //   changes. If there's more work than the pool covers at a stage's batch
+    //   size, the batches just get bigger.
+    static constexpr size_t k_range_jobs_per_thread{ 4 };
+    static constexpr size_t k_max_range_stages_per_state{ 3 };  // J9, J10 and J12.
+    size_t m_max_range_jobs{ 0 };
+
+    template<typename Job_t>
+    void create_jobs(std::vector<std::unique_ptr<Job_t>>& jobs, size_t num_jobs);
+    template<typename Job_t>
+    void emit_range_jobs(std::vector<std::unique_ptr<Job_t>>& jobs,
+                         size_t count,
+                         size_t batch_size,
+                         std::vector<Job_ifc*>& out_jobs);
+    void reserve_next_jobs();
+
     // States.
     enum class Job_source_state : uint32_t
     {
@@ -121,8 +384,13 @@ private:
         // Main cycle.
         WAIT_UNTIL_TIMEOUT,
 
-        EXECUTE_LOGIC_UPDATE,  // Read input, logic step, calc skeletal anim bone matrices, write physics inputs, etc.
-        STEP_PHYSICS_WORLD,    // Run physics world update procedure.
+        EXECUTE_LOGIC_UPDATE,    // Read input, logic step, calc skeletal anim bone matrices, write physics inputs, etc.
+        STEP_PHYSICS_WORLD,      // Run physics world update procedure.
+        FIND_COMBAT_CANDIDATES,  // Pair the hurtboxes with nearby hitboxes (one broadphase pass), and collect the contact events.
+        RUN_PHYSICS_QUERIES,     // Update triggers, query hurtboxes and run scene queries against the stepped world.
+        REPORT_COMBAT_HITS,      // Report the hits found by the hurtbox queries.
+        DISPATCH_CONTACT_EVENTS, // Deliver the contact events recorded during the step (once nothing reads the world anymore).
+        PROPAGATE_TRANSFORMS,    // Write simulated transforms into the transform holders.
 
         REMOVE_PENDING_SIM_OBJS,
         ADD_PENDING_SIM_OBJS,
@@ -131,22 +399,107 @@ private:
         NUM_STATES
     };
     std::atomic<Job_source_state> m_current_state;
-    Job_timekeeper m_timekeeper;
+    std::atomic_uint64_t m_tick_count{ 0 };
+    world_sim::Tick_pacer m_tick_pacer;
     Job_next_jobs_return_data fetch_next_jobs_callback() override;
 
-    // Insertion and deletion queues.
-    std::vector<std::unique_ptr<simulating::Entity_ifc>> m_insertion_queue;
-    std::mutex m_insertion_queue_mutex;
-    std::vector<size_t> m_deletion_indices_queue;
-    std::mutex m_deletion_indices_queue_mutex;
+    // Jobs of the current fetch (capacity is kept between fetches).
+    std::vector<Job_ifc*> m_next_jobs;
 
+    // Insertion and deletion queues.
+    // @NOTE: Lock-free so that gameplay threads never block on the tick.
+    //   Drained by J3/J4.
+    world_sim::Mpsc_queue<std::unique_ptr<simulating::Entity_ifc>> m_insertion_queue;
+    world_sim::Mpsc_queue<entity_key_t> m_deletion_keys_queue;
+
+    // Entity slot map.
+    // @NOTE: Free slots are linked together with `next_free_idx`, and the
+    //   version gets bumped every time a slot gets reused, so stale keys get
+    //   rejected.
     static constexpr uint32_t k_num_max_entities{ 1024 };
-    std::vector<std::unique_ptr<simulating::Entity_ifc>> m_entity_pool;
+    static constexpr uint32_t k_no_free_entity_idx{ (uint32_t)-1 };
+    struct Entity_slot
+    {
+        std::unique_ptr<simulating::Entity_ifc> entity{ nullptr };
+        uint32_t version{ 0 };
+        uint32_t next_free_idx{ k_no_free_entity_idx };
+    };
+    std::vector<Entity_slot> m_entity_pool;
+    uint32_t m_entity_pool_free_head{ k_no_free_entity_idx };
     std::mutex m_entity_pool_mutex;
 
-    std::atomic_size_t m_behavior_pool_key_generator{ 0 };
-    std::unordered_map<behavior_group_key_t, Behavior_group> m_behavior_pool;
-    std::mutex m_behavior_pool_mutex;
+    // Behavior group slot map.
+    // @NOTE: The groups are stored densely (swap-remove) so that iterating
+    //   them is linear. Keys go through the slot table, whose versions get
+    //   bumped every time a slot gets reused, so stale keys get rejected.
+    //   Adds and removes get queued and applied at the start of the next
+    //   logic update, so nothing in the logic phase takes the slot table
+    //   mutex. Keys get handed out right away (the slot is reserved).
+    static constexpr uint32_t k_no_behavior_group_idx{ (uint32_t)-1 };
+    struct Behavior_group_slot
+    {
+        uint32_t dense_idx{ k_no_behavior_group_idx };  // None while pending add.
+        uint32_t version{ 0 };
+        uint32_t next_free_idx{ k_no_behavior_group_idx };
+        bool in_use{ false };
+    };
+    std::vector<Behavior_group_slot> m_behavior_group_slots;
+    uint32_t m_behavior_group_free_head{ k_no_behavior_group_idx };
+    std::mutex m_behavior_group_slots_mutex;
+
+    std::vector<Behavior_group> m_behavior_groups;
+    std::vector<uint32_t> m_behavior_group_slot_idxs;  // Parallel to `m_behavior_groups`.
+
+    world_sim::Mpsc_queue<std::pair<behavior_group_key_t, Behavior_group>> m_pending_behavior_group_adds;
+    world_sim::Mpsc_queue<behavior_group_key_t> m_pending_behavior_group_removes;
+
+    bool apply_pending_behavior_group_edits();
+
+    // Behavior schedule.
+    // @NOTE: The behaviors of all the groups, rebuilt whenever the behavior
+    //   groups change. They all run in one parallel pass with no ordering
+    //   between them: behavior data reads see last tick's committed blocks
+    //   (see `Behavior_data_w_version`), so a producer's write this tick
+    //   only reaches its consumers next tick no matter when either runs.
+    bool m_behavior_schedule_dirty{ false };
+    std::vector<simulating::Behavior_ifc*> m_behavior_schedule_nodes;  // Sorted by job.
+
+    // Cost-aware partitioning of the schedule.
+    // @NOTE: Every `k_behavior_cost_sample_interval` ticks the J2 jobs time
+    //   each behavior and fold it into an exponential moving average. After
+    //   a sample tick, the schedule gets repacked into about `num_threads *
+    //   k_behavior_jobs_per_thread` jobs of similar cost (longest processing
+    //   time first), so one heavy entity doesn't set the tail of the logic
+    //   update. Work stealing evens out the rest.
+    static constexpr uint64_t k_behavior_cost_sample_interval{ 16 };
+    static constexpr float_t k_behavior_cost_ema_alpha{ 0.25f };
+    static constexpr float_t k_default_behavior_cost_ns{ 1000.0f };  // Until measured.
+    static constexpr float_t k_min_behavior_job_cost_ns{ 20000.0f };
+    static constexpr uint32_t k_behavior_jobs_per_thread{ 4 };
+    uint32_t m_num_threads;
+    std::vector<float_t> m_behavior_schedule_costs;  // Parallel to `m_behavior_schedule_nodes`. Negative if not measured.
+    std::vector<size_t> m_behavior_schedule_job_ends;
+    bool m_measuring_behavior_costs{ false };
+    bool m_behavior_costs_measured{ false };
+
+    // Repartitioning scratch space (kept so that it doesn't allocate).
+    struct Behavior_partition_scratch
+    {
+        std::vector<std::pair<float_t, size_t>> sorted_nodes;  // (cost, node idx).
+        std::vector<std::pair<float_t, size_t>> job_loads;     // (total cost, job idx). Min heap.
+        std::vector<size_t> node_jobs;
+        std::vector<size_t> job_offsets;
+        std::vector<simulating::Behavior_ifc*> packed_nodes;
+        std::vector<float_t> packed_costs;
+    } m_behavior_partition_scratch;
+
+    void rebuild_behavior_schedule();
+    void partition_behavior_schedule();
+    void emit_behavior_jobs(std::vector<Job_ifc*>& out_jobs);
+
+    // Batched behaviors (indexed by type idx).
+    std::vector<std::unique_ptr<simulating::Behavior_batch_ifc>> m_behavior_batches;
+    std::mutex m_behavior_batches_mutex;
 
     // Physics system.
     std::unique_ptr<JPH::PhysicsSystem> m_physics_system;
@@ -0,0 +1,76 @@
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+
+#if HAWSOO_COUNT_ALLOCATIONS
+
+namespace alloc_counter
+{
+
+static std::atomic_uint64_t s_num_allocations{ 0 };
+static thread_local uint32_t t_exempt_depth{ 0 };
+
+}  // namespace alloc_counter
+
+uint64_t alloc_counter::get_num_allocations()
+{
+    return s_num_allocations.load(std::memory_order_relaxed);
+}
+
+alloc_counter::Scoped_exempt::Scoped_exempt()
+{
+    t_exempt_depth++;
+}
+
+alloc_counter::Scoped_exempt::~Scoped_exempt()
+{
+    t_exempt_depth--;
+}
+
+// Global allocation functions.
+// @NOTE: The array and nothrow forms forward to these by default. The
+//   over-aligned forms aren't replaced (and aren't counted).
+void* operator new(std::size_t size)
+{
+    if (alloc_counter::t_exempt_depth == 0)
+    {
+        alloc_counter::s_num_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* ptr{ std::malloc(size == 0 ? 1 : size) };
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#else
+
+uint64_t alloc_counter::get_num_allocations()
+{
+    return 0;
+}
+
+alloc_counter::Scoped_exempt::Scoped_exempt()
+{
+}
+
+alloc_counter::Scoped_exempt::~Scoped_exempt()
+{
+}
+
+#endif  // HAWSOO_COUNT_ALLOCATIONS
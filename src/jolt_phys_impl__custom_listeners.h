@@ -1,75 +1,54 @@
 #pragma once
 
 #include "jolt_physics_headers.h"
+#include "physics_objects.h"
 
 
-// An example activation listener
+// Tracks the active body set for transform propagation.
 class My_body_activation_listener : public JPH::BodyActivationListener
 {
 public:
     virtual void OnBodyActivated(const JPH::BodyID& in_body_id, uint64_t in_body_user_data) override
     {
-        //std::cout << "A body got activated" << std::endl;
+        phys_obj::notify_body_activated(in_body_id);
     }
 
     virtual void OnBodyDeactivated(const JPH::BodyID& in_body_id, uint64_t in_body_user_data) override
     {
-        //std::cout << "A body went to sleep" << std::endl;
+        phys_obj::notify_body_deactivated(in_body_id);
     }
 };
 
 
-// An example contact listener
+// Records contact events for the bodies subscribed to them.
+// @NOTE: Gets called from inside Jolt's parallel narrow phase, so it only
+//   appends to the per-thread buffers (see `phys_obj::record_contact_event()`).
+//   The events get delivered after the step.
 class My_contact_listener : public JPH::ContactListener
 {
 public:
     // See: ContactListener
     virtual JPH::ValidateResult OnContactValidate(const JPH::Body& in_body1, const JPH::Body& in_body2, JPH::RVec3Arg inBaseOffset, const JPH::CollideShapeResult& inCollisionResult) override
     {
-        //std::cout << "Contact validate callback" << std::endl;
-
         // Allows you to ignore a contact before it is created (using layers to not make objects collide is cheaper!)
         return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
     }
 
-    void process_user_data_meaning(const JPH::Body& this_body, const JPH::Body& other_body, const JPH::ContactManifold& manifold, JPH::ContactSettings& io_settings)
-    {
-        // @TODO: Implement as needed!
-
-        // switch (UserDataMeaning(this_body.GetUserData()))
-        // {
-        // case UserDataMeaning::NOTHING:
-        //     break;
-        
-        // case UserDataMeaning::IS_CHARACTER:
-        // {
-        //     SimulationCharacter* entityAsChar;
-        //     if (entityAsChar = dynamic_cast<SimulationCharacter*>(entityManager->getEntityViaGUID(bodyIdToEntityGuidMap[this_body.GetID()])))
-        //         entityAsChar->reportPhysicsContact(other_body, manifold, &io_settings);
-        //     break;
-        // }
-        // }
-    }
-
     virtual void OnContactAdded(const JPH::Body& in_body1,
                                 const JPH::Body& in_body2,
                                 const JPH::ContactManifold& in_manifold,
                                 JPH::ContactSettings& io_settings) override
     {
-        //std::cout << "A contact was added" << std::endl;
-        process_user_data_meaning(in_body1, in_body2, in_manifold, io_settings);
-        process_user_data_meaning(in_body2, in_body1, in_manifold.SwapShapes(), io_settings);
+        phys_obj::record_contact_event(phys_obj::CONTACT_EVENT_ADDED, in_body1, in_body2, in_manifold);
     }
 
     virtual void OnContactPersisted(const JPH::Body& in_body1, const JPH::Body& in_body2, const JPH::ContactManifold& in_manifold, JPH::ContactSettings& io_settings) override
     {
-        //std::cout << "A contact was persisted" << std::endl;
-        process_user_data_meaning(in_body1, in_body2, in_manifold, io_settings);
-        process_user_data_meaning(in_body2, in_body1, in_manifold.SwapShapes(), io_settings);
+        phys_obj::record_contact_event(phys_obj::CONTACT_EVENT_PERSISTED, in_body1, in_body2, in_manifold);
     }
 
     virtual void OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) override
     {
-        //std::cout << "A contact was removed" << std::endl;
+        phys_obj::record_contact_removed(inSubShapePair);
     }
 };
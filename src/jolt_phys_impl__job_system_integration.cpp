@@ -1,69 +1,214 @@
-#if 0
-
 #include "jolt_phys_impl__job_system_integration.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
-#include <chrono>
 #include <cinttypes>
+#include <cstdlib>  // std::abort
+#include <iostream>
 #include <thread>
 #include "Jolt/Jolt.h"
 #include "Jolt/Core/JobSystemWithBarrier.h"
 #include "Jolt/Core/Profiler.h"
 #include "Jolt/Core/FPException.h"
+#include "alloc_counter.h"
+#include "tick_profiler.h"
 
 
 Job_system_integration::Job_system_integration(uint32_t in_max_jobs, uint32_t in_max_barriers, int32_t in_num_threads)
-    : m_num_threads(in_num_threads)
 {
     // @ASSERT: If this is a single-threaded application, use the single threaded job system!
-    assert(m_num_threads > 1);
+    assert(in_num_threads > 1);
 
-    init(in_max_jobs, in_max_barriers, m_num_threads);
+    init(in_max_jobs, in_max_barriers, in_num_threads);
 }
 
 Job_system_integration::~Job_system_integration()
-{}
+{
+    // Release any jobs that were never executed.
+    while (Job* job = try_pop_job())
+    {
+        job->Release();
+    }
+}
 
 void Job_system_integration::init(uint32_t in_max_jobs, uint32_t in_max_barriers, int32_t in_num_threads)
-{}
+{
+    assert(!m_is_initialized);
+
+    JobSystemWithBarrier::Init(in_max_barriers);
+
+    // @NOTE: Running out of jobs is fatal (see `CreateJob()`), so the free
+    //   list has to fit everything Jolt may create during a step.
+    assert(in_max_jobs >= static_cast<uint32_t>(JPH::cMaxPhysicsJobs));
+
+    // Init freelist of jobs.
+    m_jobs.Init(in_max_jobs, in_max_jobs);
+
+    // Init queue.
+    for (auto& slot : m_queue)
+    {
+        slot = nullptr;
+    }
+    m_head = 0;
+    m_tail = 0;
+
+    // Init worker jobs.
+    m_drain_jobs.reserve(in_num_threads);
+    while (m_drain_jobs.size() < static_cast<size_t>(in_num_threads))
+    {
+        m_drain_jobs.emplace_back(std::make_unique<Drain_physics_jobs_job>(*this));
+    }
+    m_num_threads.store(in_num_threads, std::memory_order_relaxed);
+
+    m_is_initialized = true;
+}
 
 // See JobSystem
 JPH::JobSystem::JobHandle Job_system_integration::CreateJob(const char *in_name,
                                                             JPH::ColorArg in_color,
                                                             const JobFunction &in_job_function,
                                                             uint32_t in_num_dependencies /*= 0*/)
-{}
+{
+    JPH_PROFILE_FUNCTION();
+
+    uint32_t index{
+        m_jobs.ConstructObject(in_name, in_color, this, in_job_function, in_num_dependencies) };
+    if (index == Available_jobs::cInvalidObjectIndex)
+    {
+        // @NOTE: The free list is sized for Jolt's max jobs bound, so this
+        //   means that bound got broken. Waiting for a free job could hang
+        //   forever if the jobs holding them depend on this one.
+        std::cerr << "ERROR: Ran out of physics jobs (job: " << in_name << ")." << std::endl;
+        assert(false);
+        std::abort();
+    }
+    Job* job{ &m_jobs.Get(index) };
+
+    // Construct handle to keep a reference, the job is queued below and may immediately complete.
+    JobHandle handle(job);
+
+    // If there are no dependencies, queue the job now.
+    if (in_num_dependencies == 0)
+    {
+        QueueJob(job);
+    }
+
+    return handle;
+}
 
 /// Change the max concurrency after initialization
-void Job_system_integration::set_num_threads_usage(int in_num_threads) {
-    // StopThreads(); StartThreads(in_num_threads);
-    assert(false);
+void Job_system_integration::set_num_threads_usage(int in_num_threads)
+{
+    // @NOTE: The worker job list doesn't change after `init()`, since
+    //   `fetch_next_jobs_callback()` reads it from other threads.
+    assert(in_num_threads > 1);
+    if (in_num_threads > static_cast<int>(m_drain_jobs.size()))
+    {
+        std::cerr << "ERROR: Physics job system concurrency can't go above " << m_drain_jobs.size() << " (requested " << in_num_threads << ")." << std::endl;
+        assert(false);
+        in_num_threads = static_cast<int>(m_drain_jobs.size());
+    }
+    m_num_threads.store(in_num_threads, std::memory_order_relaxed);
 }
 
 // See JobSystem
 void Job_system_integration::QueueJob(Job *inJob)
-{}
+{
+    JPH_PROFILE_FUNCTION();
+    queue_job_internal(inJob);
+}
 
 void Job_system_integration::QueueJobs(Job **inJobs, uint32_t inNumJobs)
-{}
+{
+    JPH_PROFILE_FUNCTION();
+    assert(inNumJobs > 0);
 
-void Job_system_integration::FreeJob(Job *inJob)
-{}
+    for (Job** job = inJobs, **job_end = inJobs + inNumJobs; job < job_end; job++)
+    {
+        queue_job_internal(*job);
+    }
+}
 
-// private:
-// /// Start/stop the worker threads
-// void start_threads(int in_num_threads);
-// void stop_threads();
+void Job_system_integration::FreeJob(Job *inJob)
+{
+    m_jobs.DestructObject(inJob);
+}
 
-inline uint32_t Job_system_integration::get_head() const
+inline void Job_system_integration::queue_job_internal(Job *inJob)
 {
+    // Add reference to job because we're adding the job to the queue.
+    inJob->AddRef();
+
+    // Reserve a slot at the tail.
+    uint32_t tail{ m_tail.fetch_add(1, std::memory_order_acq_rel) };
+    auto& slot{ m_queue[tail & (k_queue_length - 1)] };
+
+    // Wait for the slot to get freed up by a reader (only happens when the queue is full).
+    Job* expected{ nullptr };
+    while (!slot.compare_exchange_weak(expected, inJob, std::memory_order_release))
+    {
+        expected = nullptr;
+        std::this_thread::yield();
+    }
+}
 
+Job_system_integration::Job* Job_system_integration::try_pop_job()
+{
+    uint32_t head{ m_head.load(std::memory_order_acquire) };
+    do
+    {
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            // Queue is empty.
+            return nullptr;
+        }
+    } while (!m_head.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel));
+
+    // Claimed slot. Wait for the writer to finish writing the job.
+    auto& slot{ m_queue[head & (k_queue_length - 1)] };
+    Job* job{ nullptr };
+    while ((job = slot.exchange(nullptr, std::memory_order_acquire)) == nullptr)
+    {
+        std::this_thread::yield();
+    }
+
+    return job;
 }
 
-inline void Job_system_integration::queue_job_internal(Job *inJob)
+// Jobs.
+int32_t Job_system_integration::Drain_physics_jobs_job::execute()
 {
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_STEP_PHYSICS, "Jolt physics drain jobs");
+
+    while (Job* job = m_job_system.try_pop_job())
+    {
+        job->Execute();
+        job->Release();
+    }
 
+    return 0;
 }
 
-#endif  // 0
+// Job source callback.
+Job_source::Job_next_jobs_return_data Job_system_integration::fetch_next_jobs_callback()
+{
+    Job_next_jobs_return_data return_data;
+
+    if (m_is_initialized)
+    {
+        // Hand out as many workers as there are queued jobs (up to the max concurrency).
+        uint32_t num_workers{
+            std::min(get_num_queued_jobs(),
+                     static_cast<uint32_t>(m_num_threads.load(std::memory_order_relaxed))) };
+        // @NOTE: The job system owns the list after this.
+        HAWSOO_ALLOC_COUNTER_EXEMPT_SCOPE();
+        return_data.jobs.reserve(num_workers);
+        for (uint32_t i = 0; i < num_workers; i++)
+        {
+            return_data.jobs.emplace_back(m_drain_jobs[i].get());
+        }
+    }
+
+    return return_data;
+}
@@ -2,44 +2,49 @@
 
 #include <atomic>
 #include <cinttypes>
+#include <memory>
+#include <vector>
 #include "jolt_physics_headers.h"
 #include "Jolt/Core/JobSystemWithBarrier.h"
 #include "Jolt/Core/FixedSizeFreeList.h"
-#include "Jolt/Core/Semaphore.h"
+#include "multithreaded_job_system_public.h"
 
 
-/// Implementation of a JobSystem using a thread pool
-/// 
-/// Note that this is considered an example implementation. It is expected that when you integrate
-/// the physics engine into your own project that you'll provide your own implementation of the
-/// JobSystem built on top of whatever job system your project uses.
-class Job_system_integration final : public JPH::JobSystemWithBarrier
+/// Implementation of a JobSystem on top of the engine job system.
+///
+/// Jolt jobs get pushed into a fixed size queue, and this job source hands out
+/// `Job_ifc` worker jobs that drain the queue on the engine's worker threads.
+/// The thread blocked inside `PhysicsSystem::Update()` also executes jobs while
+/// it waits on a barrier (see `JobSystemWithBarrier`), so no extra thread pool
+/// gets created.
+class Job_system_integration final : public JPH::JobSystemWithBarrier, public Job_source
 {
 public:
     JPH_OVERRIDE_NEW_DELETE
 
-    /// Creates a thread pool.
-    /// @see Job_system_integration::Init
+    /// Creates and initializes the job system.
+    /// @see Job_system_integration::init
     Job_system_integration(uint32_t in_max_jobs, uint32_t in_max_barriers, int32_t in_num_threads);
     Job_system_integration() = default;
     virtual ~Job_system_integration() override;
 
-    /// Initialize the thread pool
-    /// @param inMaxJobs Max number of jobs that can be allocated at any time
+    /// Initialize the job system
+    /// @param inMaxJobs Max number of jobs that can be allocated at any time (at least `JPH::cMaxPhysicsJobs`)
     /// @param inMaxBarriers Max number of barriers that can be allocated at any time
-    /// @param inNumThreads Number of threads to start (the number of concurrent jobs is 1 more because the main thread will also run jobs while waiting for a barrier to complete). Use -1 to autodetect the amount of CPU's.
+    /// @param inNumThreads Max number of engine workers that will execute physics jobs at the same time (fixed after init).
     void init(uint32_t in_max_jobs, uint32_t in_max_barriers, int32_t in_num_threads);
 
     // See JobSystem
     virtual int GetMaxConcurrency() const override
     {
-        return m_num_threads;
+        return m_num_threads.load(std::memory_order_relaxed);
     }
     virtual JobHandle CreateJob(const char *in_name, JPH::ColorArg in_color, const JobFunction &in_job_function, uint32_t in_num_dependencies = 0) override;
 
     /// Change the max concurrency after initialization
+    /// @NOTE: Can't go above the `in_num_threads` passed to `init()`.
     void set_num_threads_usage(int in_num_threads);
-    
+
 protected:
     // See JobSystem
     virtual void QueueJob(Job *inJob) override;
@@ -48,37 +53,57 @@ protected:
 
 private:
     // Storage for concurrency.
-    int32_t m_num_threads;
-
-    /// Start/stop the worker threads
-    void start_threads(int in_num_threads);
-    void stop_threads();
-    
-    // /// Entry point for a thread
-    // void ThreadMain(int inThreadIndex);
-
-    /// Get the head of the thread that has processed the least amount of jobs
-    inline uint32_t get_head() const;
+    // @NOTE: Read from `fetch_next_jobs_callback()` on other threads.
+    std::atomic_int32_t m_num_threads{ 0 };
+    std::atomic_bool m_is_initialized{ false };
 
     /// Internal helper function to queue a job
     inline void queue_job_internal(Job *inJob);
 
+    /// Pops a job off the queue. Returns nullptr if the queue is empty.
+    Job* try_pop_job();
+
+    /// Number of jobs that are queued but haven't been popped yet.
+    inline uint32_t get_num_queued_jobs() const
+    {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
     /// Array of jobs (fixed size)
     using Available_jobs = JPH::FixedSizeFreeList<Job>;
     Available_jobs m_jobs;
 
     // The job queue
-    static constexpr uint32_t k_queue_length{ 1024 };
+    // @NOTE: Big enough to hold every job that Jolt can have alive at once, so
+    //   queueing never has to wait for a free slot.
+    static constexpr uint32_t k_queue_length{ 4096 };
     static_assert(JPH::IsPowerOf2(k_queue_length)); // We do bit operations and require queue length to be a power of 2
+    static_assert(k_queue_length >= static_cast<uint32_t>(JPH::cMaxPhysicsJobs));
     std::atomic<Job*> m_queue[k_queue_length];
 
-    // Head and tail of the queue, do this value modulo k_queue_length - 1 to get the element in the mQueue array
-    std::atomic<uint32_t>* m_heads{ nullptr }; ///< Per executing thread the head of the current queue
+    // Head and tail of the queue, do this value modulo k_queue_length - 1 to get the element in the m_queue array
+    alignas(JPH_CACHE_LINE_SIZE) std::atomic<uint32_t> m_head{ 0 }; ///< Head (read end) of the queue
     alignas(JPH_CACHE_LINE_SIZE) std::atomic<uint32_t> m_tail{ 0 }; ///< Tail (write end) of the queue
 
-    // Semaphore used to signal worker threads that there is new work
-    JPH::Semaphore m_semaphore;
+    // Engine job system integration.
+    // @NOTE: Each worker job keeps draining the queue until it's empty, so the
+    //   number of worker jobs handed out is the amount of engine threads that
+    //   are executing physics jobs at once.
+    class Drain_physics_jobs_job : public Job_ifc
+    {
+    public:
+        Drain_physics_jobs_job(Job_system_integration& job_system)
+            : Job_ifc("Jolt physics drain jobs job", job_system)
+            , m_job_system(job_system)
+        {
+        }
+
+        int32_t execute() override;
+
+    private:
+        Job_system_integration& m_job_system;
+    };
+    std::vector<std::unique_ptr<Drain_physics_jobs_job>> m_drain_jobs;  // @NOTE: Created in `init()` only.
 
-    /// Boolean to indicate that we want to stop the job system
-    std::atomic<bool> m_quit{ false };
+    Job_next_jobs_return_data fetch_next_jobs_callback() override;
 };
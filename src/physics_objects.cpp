@@ -5,7 +5,16 @@
 #include "jolt_phys_impl__layers.h"
 #include "world_simulation_settings.h"
 
-#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <cmath>  // std::ceil, std::acos
+#include <functional>  // std::less
+#include <iterator>  // std::back_inserter
+#include <mutex>
+#include <string>
+#include <tuple>  // std::tie
+#include <unordered_map>
+#include <utility>  // std::swap
 
 
 namespace phys_obj
@@ -14,100 +23,603 @@ namespace phys_obj
 static JPH::PhysicsSystem* s_physics_system{ nullptr };
 static JPH::BodyInterface* s_body_interface_ptr{ nullptr };
 static JPH::JobSystem* s_job_system_ptr{ nullptr };
+static std::atomic<float_t> s_tick_delta_time{ 1.0f / k_world_sim_hz };
 
-Shape_const_reference create_shape(Shape_type shape_type,
-                                   Shape_params_ptr shape_param);
+// Transform propagation.
+static std::atomic<Transform_holder*> s_transform_holders_by_body_idx[k_max_bodies];
+
+static std::mutex s_active_bodies_mutex;
+static std::vector<uint32_t> s_active_body_idxs;
+static uint32_t s_active_body_idx_positions[k_max_bodies];  // Position in `s_active_body_idxs` for O(1) removal.
+static constexpr uint32_t k_not_active{ (uint32_t)-1 };
+
+// @NOTE: Bodies that stopped moving need to be written `k_num_buffers` more
+//   times so that every buffer in the triple buffer holds the resting transform.
+static std::mutex s_settling_bodies_mutex;
+static std::vector<uint32_t> s_settling_body_idxs;
+static uint8_t s_settling_countdowns[k_max_bodies];
+
+static std::vector<Transform_holder*> s_moved_transform_holders;
+
+// Bodies created but not added to the physics world yet.
+static std::mutex s_pending_add_bodies_mutex;
+static std::vector<JPH::BodyID> s_pending_add_body_ids;
+
+// Contact events.
+static std::atomic<Contact_receiver_ifc*> s_contact_receivers_by_body_idx[k_max_bodies];
+static std::atomic<contact_event_flags_t> s_contact_event_flags_by_body_idx[k_max_bodies];
+
+struct Recorded_contact_event
+{
+    Contact_receiver_ifc* receiver;
+    Contact_event event;
+};
+
+// @NOTE: Only the owning thread appends (during the step), and the buffers
+//   only get read after the step, so no locks are needed. Fixed capacity so
+//   that recording never allocates.
+struct Contact_event_buffer
+{
+    std::vector<Recorded_contact_event> events;
+    uint64_t num_dropped{ 0 };
+};
+static constexpr size_t k_contact_events_per_thread{ 4096 };
+static std::mutex s_contact_event_buffers_mutex;  // Registration and collection.
+static std::vector<std::unique_ptr<Contact_event_buffer>> s_contact_event_buffers;
+
+static std::vector<Recorded_contact_event> s_collected_contact_events;
+static std::vector<Contact_event> s_sorted_contact_events;
+static std::vector<std::pair<Contact_receiver_ifc*, size_t>> s_contact_receiver_batches;  // (receiver, end).
+
+Contact_event_buffer& get_thread_contact_event_buffer();
+void push_contact_event(Contact_event_buffer& buffer,
+                        uint32_t body_idx,
+                        Contact_event&& event);
+void reserve_collected_contact_events(size_t num_buffers);
+
+// @NOTE: The trigger, hurtbox and scene queries read the stepped world
+//   without locking, while contact receivers may move their bodies. These
+//   count the jobs of each running, to assert that they never overlap.
+static std::atomic_uint32_t s_num_running_world_queries{ 0 };
+static std::atomic_uint32_t s_num_running_contact_dispatches{ 0 };
+
+class Scoped_world_access
+{
+public:
+    Scoped_world_access(std::atomic_uint32_t& running, const std::atomic_uint32_t& excluded)
+        : m_running(running)
+    {
+        m_running.fetch_add(1, std::memory_order_acq_rel);
+        assert(excluded.load(std::memory_order_acquire) == 0);
+    }
+    ~Scoped_world_access()
+    {
+        m_running.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    Scoped_world_access(const Scoped_world_access&)            = delete;
+    Scoped_world_access& operator=(const Scoped_world_access&) = delete;
+
+private:
+    std::atomic_uint32_t& m_running;
+};
+
+// Character controller types by body (for filtering trigger overlaps).
+static std::atomic<uint32_t> s_char_ctrller_types_by_body_idx[k_max_bodies];
+
+// Triggers.
+static constexpr size_t k_max_trigger_overlaps{ 64 };
+static std::mutex s_triggers_mutex;
+static std::vector<Trigger_kinematic*> s_triggers;
+
+// Combat (hitboxes and hurtboxes).
+static constexpr size_t k_max_hits_per_swing{ 64 };
+static std::mutex s_hurtboxes_mutex;
+static std::vector<Hurtbox_ifc*> s_hurtboxes;
+static std::vector<Hurtbox_ifc*> s_active_hurtboxes;  // Collected each tick.
+
+// Hitboxes found by the combat stage's broadphase pass (capacity is kept
+// between ticks).
+struct Combat_hitbox
+{
+    Hitbox_ifc* hitbox;
+    JPH::TransformedShape shape;
+    JPH::AABox bounds;
+};
+static std::vector<JPH::BodyID> s_combat_hitbox_body_ids;
+static std::vector<Combat_hitbox> s_combat_hitboxes;
+static std::vector<std::pair<uint32_t, uint32_t>> s_combat_pairs;  // (active hurtbox idx, hitbox idx).
+static std::vector<uint32_t> s_combat_candidate_hitbox_idxs;  // Grouped by active hurtbox.
+
+// Scene queries.
+// @NOTE: Double buffered by tick parity. Behaviors submit into one buffer
+//   while the results of the other buffer's batch get read.
+enum Scene_query_type : uint8_t
+{
+    SCENE_QUERY_TYPE_RAY_CAST = 0,
+    SCENE_QUERY_TYPE_SHAPE_CAST,
+};
+
+struct Scene_query_request
+{
+    Scene_query_type type;
+    scene_query_layer_flags_t layers;
+    JPH::BodyID ignore_body_id;
+    JPH::RVec3 position;
+    JPH::Quat rotation;
+    JPH::Vec3 direction;
+    Shape_const_reference shape;
+};
+
+static constexpr size_t k_max_scene_queries_per_tick{ 8192 };
+static std::vector<Scene_query_request> s_scene_query_requests[2];
+static std::vector<Scene_query_result> s_scene_query_results[2];
+static std::atomic_uint32_t s_num_submitted_scene_queries{ 0 };
+static std::atomic_uint64_t s_scene_query_submit_tick{ 0 };
+static uint64_t s_scene_query_batch_tick{ (uint64_t)-1 };
+static size_t s_num_batched_scene_queries{ 0 };
+
+Scene_query_handle submit_scene_query(Scene_query_request&& request);
+
+// Shape cache.
+// @NOTE: Shapes are immutable once created, so identical shapes get shared
+//   between actors. Keyed by the shape type + the exact param bytes (and the
+//   child list for compounds).
+static std::mutex s_shape_cache_mutex;
+static std::unordered_map<std::string, Shape_const_reference> s_shape_cache;
+static uint64_t s_shape_cache_num_hits{ 0 };
+static uint64_t s_shape_cache_num_misses{ 0 };
+
+void rebind_transform_holder(JPH::BodyID body_id,
+                             const Query_physics_transform_ifc& physics_transform_ref);
+void remove_and_destroy_body(JPH::BodyID body_id);
+
+size_t get_shape_params_size(Shape_type shape_type);
+void append_shape_cache_key(std::string& in_out_key, const void* data, size_t size);
+Shape_const_reference find_or_insert_cached_shape(std::string&& key,
+                                                  const std::function<Shape_const_reference()>& create_fn);
+
+Shape_const_reference create_shape_uncached(Shape_type shape_type,
+                                            Shape_params_ptr shape_param);
+Shape_const_reference create_compound_shape(const std::vector<Shape_w_transform>& shape_params);
 
 }  // namespace phys_obj
 
 
 // References.
-void phys_obj::set_references(void* physics_system, void* body_interface, void* job_system)
+void phys_obj::set_references(void* physics_system, void* body_interface, void* job_system, uint32_t num_threads)
 {
     s_physics_system = reinterpret_cast<JPH::PhysicsSystem*>(physics_system);
     s_body_interface_ptr = reinterpret_cast<JPH::BodyInterface*>(body_interface);
     s_job_system_ptr = reinterpret_cast<JPH::JobSystem*>(job_system);
+
+    std::lock_guard<std::mutex> lock{ s_active_bodies_mutex };
+    std::fill(std::begin(s_active_body_idx_positions),
+              std::end(s_active_body_idx_positions),
+              k_not_active);
+    s_active_body_idxs.reserve(k_max_bodies);
+    s_settling_body_idxs.reserve(k_max_bodies);
+    s_moved_transform_holders.reserve(k_max_bodies);
+
+    std::lock_guard<std::mutex> lock2{ s_pending_add_bodies_mutex };
+    s_pending_add_body_ids.reserve(k_max_bodies);
+
+    std::lock_guard<std::mutex> lock3{ s_contact_event_buffers_mutex };
+    s_contact_event_buffers.reserve(num_threads);
+    reserve_collected_contact_events(num_threads);
+
+    for (size_t i = 0; i < 2; i++)
+    {
+        s_scene_query_requests[i].resize(k_max_scene_queries_per_tick);
+        s_scene_query_results[i].resize(k_max_scene_queries_per_tick);
+    }
 }
 
-// Transform_holder.
-phys_obj::Transform_holder::Transform_holder(
-    bool interpolate,
-    const Query_physics_transform_ifc& physics_transform_ref)
-    : m_interpolate_transform(interpolate)
-    , m_physics_transform_ref(physics_transform_ref)
+void phys_obj::set_tick_delta_time(float_t delta_time)
+{
+    s_tick_delta_time.store(delta_time, std::memory_order_relaxed);
+}
+
+void phys_obj::add_pending_bodies()
 {
-    auto initial_transform{ m_physics_transform_ref.query_physics_transform() };
-    for (size_t i = 0; i < k_num_buffers; i++)
+    std::lock_guard<std::mutex> lock{ s_pending_add_bodies_mutex };
+    if (s_pending_add_body_ids.empty())
     {
-        m_transform_triple_buffer[i].position[0] = initial_transform.position[0];
-        m_transform_triple_buffer[i].position[1] = initial_transform.position[1];
-        m_transform_triple_buffer[i].position[2] = initial_transform.position[2];
-        glm_quat_copy(initial_transform.rotation, m_transform_triple_buffer[i].rotation);
-        glm_vec3_copy(initial_transform.scale, m_transform_triple_buffer[i].scale);
+        return;
     }
+
+    // Insert all the bodies into the broad phase in one go.
+    auto body_ids{ s_pending_add_body_ids.data() };
+    int32_t num_bodies{ static_cast<int32_t>(s_pending_add_body_ids.size()) };
+    auto add_state{ s_body_interface_ptr->AddBodiesPrepare(body_ids, num_bodies) };
+    s_body_interface_ptr->AddBodiesFinalize(body_ids,
+                                            num_bodies,
+                                            add_state,
+                                            JPH::EActivation::Activate);
+
+    s_pending_add_body_ids.clear();
 }
 
-void phys_obj::Transform_holder::update_physics_transform()
+// Transform propagation.
+void phys_obj::notify_body_activated(JPH::BodyID body_id)
+{
+    uint32_t idx{ body_id.GetIndex() };
+
+    std::lock_guard<std::mutex> lock{ s_active_bodies_mutex };
+    if (s_active_body_idx_positions[idx] == k_not_active)
+    {
+        s_active_body_idx_positions[idx] = static_cast<uint32_t>(s_active_body_idxs.size());
+        s_active_body_idxs.emplace_back(idx);
+    }
+}
+
+void phys_obj::notify_body_deactivated(JPH::BodyID body_id)
 {
-    auto transform{ m_physics_transform_ref.query_physics_transform() };
+    uint32_t idx{ body_id.GetIndex() };
 
-    auto& current_transform{
-        m_transform_triple_buffer[(m_buffer_offset + k_write_offset) % k_num_buffers] };
+    {   // Swap remove from active bodies.
+        std::lock_guard<std::mutex> lock{ s_active_bodies_mutex };
+        uint32_t position{ s_active_body_idx_positions[idx] };
+        if (position != k_not_active)
+        {
+            uint32_t last_idx{ s_active_body_idxs.back() };
+            s_active_body_idxs[position] = last_idx;
+            s_active_body_idx_positions[last_idx] = position;
+            s_active_body_idxs.pop_back();
+            s_active_body_idx_positions[idx] = k_not_active;
+        }
+    }
 
-    current_transform.position[0] = transform.position[0];
-    current_transform.position[1] = transform.position[1];
-    current_transform.position[2] = transform.position[2];
-    glm_quat_copy(transform.rotation, current_transform.rotation);
-    glm_vec3_copy(transform.scale, current_transform.scale);
+    // Write out the resting transform.
+    mark_body_moved(body_id);
 }
 
-void phys_obj::Transform_holder::read_current_transform(mat4& out_transform, float_t t)
+void phys_obj::mark_body_moved(JPH::BodyID body_id)
+{
+    uint32_t idx{ body_id.GetIndex() };
+
+    std::lock_guard<std::mutex> lock{ s_settling_bodies_mutex };
+    if (s_settling_countdowns[idx] == 0)
+    {
+        s_settling_body_idxs.emplace_back(idx);
+    }
+    s_settling_countdowns[idx] = Transform_holder::k_num_buffers;
+}
+
+size_t phys_obj::collect_moved_transform_holders()
 {
-    // @TODO: In the future with world chunks and camera tricks for rendering large worlds,
-    //   convert the true transforms into the camera based transform here!
-    //   For now tho, it all just gets truncated.
+    s_moved_transform_holders.clear();
+
+    {   // Active bodies.
+        std::lock_guard<std::mutex> lock{ s_active_bodies_mutex };
+        for (uint32_t idx : s_active_body_idxs)
+        {
+            if (auto holder{ s_transform_holders_by_body_idx[idx].load(std::memory_order_acquire) })
+            {
+                s_moved_transform_holders.emplace_back(holder);
+            }
+        }
+    }
+
+    {   // Settling bodies.
+        std::lock_guard<std::mutex> lock1{ s_active_bodies_mutex };
+        std::lock_guard<std::mutex> lock2{ s_settling_bodies_mutex };
+        for (size_t i = 0; i < s_settling_body_idxs.size();)
+        {
+            uint32_t idx{ s_settling_body_idxs[i] };
+            if (s_active_body_idx_positions[idx] == k_not_active)
+            {
+                // Not already written as an active body.
+                if (auto holder{ s_transform_holders_by_body_idx[idx].load(std::memory_order_acquire) })
+                {
+                    s_moved_transform_holders.emplace_back(holder);
+                }
+            }
 
-    vec3   pos;
-    versor rot;
-    vec3   sca;
+            if (--s_settling_countdowns[idx] == 0)
+            {
+                // Settled. Swap remove.
+                s_settling_body_idxs[i] = s_settling_body_idxs.back();
+                s_settling_body_idxs.pop_back();
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
 
-    size_t buffer_offset_copy{ m_buffer_offset };  // To only do one atomic load.
+    return s_moved_transform_holders.size();
+}
 
-    if (m_interpolate_transform)
+void phys_obj::update_moved_transform_holders(size_t begin, size_t end)
+{
+    assert(begin <= end && end <= s_moved_transform_holders.size());
+    for (size_t i = begin; i < end; i++)
     {
-        auto& transform_a{
-            m_transform_triple_buffer[(buffer_offset_copy + k_read_a_offset) % k_num_buffers] };
-        auto& transform_b{
-            m_transform_triple_buffer[(buffer_offset_copy + k_read_b_offset) % k_num_buffers] };
+        s_moved_transform_holders[i]->update_physics_transform();
+    }
+}
 
-        // @INCOMPLETE: Truncated data (if using double real JPH::RVec3).
-        pos[0] = transform_a.position[0] + t * (transform_b.position[0] - transform_a.position[0]);
-        pos[1] = transform_a.position[1] + t * (transform_b.position[1] - transform_a.position[1]);
-        pos[2] = transform_a.position[2] + t * (transform_b.position[2] - transform_a.position[2]);
+// Contact events.
+void phys_obj::subscribe_contact_events(JPH::BodyID body_id,
+                                        Contact_receiver_ifc& receiver,
+                                        contact_event_flags_t flags)
+{
+    uint32_t idx{ body_id.GetIndex() };
+    assert(idx < k_max_bodies);
+    s_contact_receivers_by_body_idx[idx].store(&receiver, std::memory_order_relaxed);
+    s_contact_event_flags_by_body_idx[idx].store(flags, std::memory_order_relaxed);
+}
 
-        glm_quat_nlerp(transform_a.rotation, transform_b.rotation, t, rot);
+void phys_obj::unsubscribe_contact_events(JPH::BodyID body_id)
+{
+    uint32_t idx{ body_id.GetIndex() };
+    assert(idx < k_max_bodies);
+    s_contact_event_flags_by_body_idx[idx].store(0, std::memory_order_relaxed);
+    s_contact_receivers_by_body_idx[idx].store(nullptr, std::memory_order_relaxed);
+}
 
-        glm_vec3_lerp(transform_a.scale, transform_b.scale, t, sca);
+void phys_obj::record_contact_event(Contact_event_type type,
+                                    const JPH::Body& body1,
+                                    const JPH::Body& body2,
+                                    const JPH::ContactManifold& manifold)
+{
+    contact_event_flags_t flag{ static_cast<contact_event_flags_t>(1 << type) };
+    uint32_t idx1{ body1.GetID().GetIndex() };
+    uint32_t idx2{ body2.GetID().GetIndex() };
+    bool notify1{ (s_contact_event_flags_by_body_idx[idx1].load(std::memory_order_relaxed) & flag) != 0 };
+    bool notify2{ (s_contact_event_flags_by_body_idx[idx2].load(std::memory_order_relaxed) & flag) != 0 };
+    if (!notify1 && !notify2)
+    {
+        // Nobody's listening.
+        return;
     }
-    else
+
+    // @NOTE: The manifold normal points from body 1 towards body 2.
+    JPH::Vec3 normal{ manifold.mWorldSpaceNormal };
+    float_t approach_speed{
+        -(body2.GetLinearVelocity() - body1.GetLinearVelocity()).Dot(normal) };
+
+    auto& buffer{ get_thread_contact_event_buffer() };
+    if (notify1)
+    {
+        push_contact_event(buffer, idx1, {
+            .body_id{ body1.GetID() },
+            .other_body_id{ body2.GetID() },
+            .other_user_data{ body2.GetUserData() },
+            .normal{ normal.GetX(), normal.GetY(), normal.GetZ() },
+            .penetration_depth{ manifold.mPenetrationDepth },
+            .approach_speed{ approach_speed },
+            .type{ type },
+        });
+    }
+    if (notify2)
+    {
+        push_contact_event(buffer, idx2, {
+            .body_id{ body2.GetID() },
+            .other_body_id{ body1.GetID() },
+            .other_user_data{ body1.GetUserData() },
+            .normal{ -normal.GetX(), -normal.GetY(), -normal.GetZ() },
+            .penetration_depth{ manifold.mPenetrationDepth },
+            .approach_speed{ approach_speed },
+            .type{ type },
+        });
+    }
+}
+
+void phys_obj::record_contact_removed(const JPH::SubShapeIDPair& sub_shape_pair)
+{
+    // @NOTE: The bodies may already be gone, so only the IDs are known.
+    constexpr contact_event_flags_t k_flag{ k_contact_event_flag_removed };
+    JPH::BodyID body_id1{ sub_shape_pair.GetBody1ID() };
+    JPH::BodyID body_id2{ sub_shape_pair.GetBody2ID() };
+    bool notify1{ (s_contact_event_flags_by_body_idx[body_id1.GetIndex()].load(std::memory_order_relaxed) & k_flag) != 0 };
+    bool notify2{ (s_contact_event_flags_by_body_idx[body_id2.GetIndex()].load(std::memory_order_relaxed) & k_flag) != 0 };
+    if (!notify1 && !notify2)
+    {
+        return;
+    }
+
+    auto& buffer{ get_thread_contact_event_buffer() };
+    if (notify1)
+    {
+        push_contact_event(buffer, body_id1.GetIndex(), {
+            .body_id{ body_id1 },
+            .other_body_id{ body_id2 },
+            .other_user_data{ 0 },
+            .normal{ 0.0f, 0.0f, 0.0f },
+            .penetration_depth{ 0.0f },
+            .approach_speed{ 0.0f },
+            .type{ CONTACT_EVENT_REMOVED },
+        });
+    }
+    if (notify2)
+    {
+        push_contact_event(buffer, body_id2.GetIndex(), {
+            .body_id{ body_id2 },
+            .other_body_id{ body_id1 },
+            .other_user_data{ 0 },
+            .normal{ 0.0f, 0.0f, 0.0f },
+            .penetration_depth{ 0.0f },
+            .approach_speed{ 0.0f },
+            .type{ CONTACT_EVENT_REMOVED },
+        });
+    }
+}
+
+size_t phys_obj::collect_contact_events()
+{
+    s_collected_contact_events.clear();
+    s_sorted_contact_events.clear();
+    s_contact_receiver_batches.clear();
+
+    uint64_t num_dropped{ 0 };
+    {
+        std::lock_guard<std::mutex> lock{ s_contact_event_buffers_mutex };
+        for (auto& buffer : s_contact_event_buffers)
+        {
+            s_collected_contact_events.insert(s_collected_contact_events.end(),
+                                              buffer->events.begin(),
+                                              buffer->events.end());
+            buffer->events.clear();
+            num_dropped += buffer->num_dropped;
+            buffer->num_dropped = 0;
+        }
+    }
+
+    if (num_dropped > 0)
+    {
+        std::cerr << "WARNING: Dropped " << num_dropped << " contact events (per thread buffer full)." << std::endl;
+    }
+
+    // Group by receiver. Order within a batch doesn't depend on which thread
+    // recorded what.
+    std::sort(s_collected_contact_events.begin(),
+              s_collected_contact_events.end(),
+              [](const Recorded_contact_event& a, const Recorded_contact_event& b) {
+                  if (a.receiver != b.receiver)
+                  {
+                      return std::less<Contact_receiver_ifc*>{}(a.receiver, b.receiver);
+                  }
+                  return (std::tie(a.event.body_id, a.event.other_body_id, a.event.type) <
+                          std::tie(b.event.body_id, b.event.other_body_id, b.event.type));
+              });
+
+    for (auto& recorded : s_collected_contact_events)
+    {
+        if (s_contact_receiver_batches.empty() ||
+            s_contact_receiver_batches.back().first != recorded.receiver)
+        {
+            s_contact_receiver_batches.emplace_back(recorded.receiver, 0);
+        }
+        s_sorted_contact_events.emplace_back(recorded.event);
+        s_contact_receiver_batches.back().second = s_sorted_contact_events.size();
+    }
+
+    return s_contact_receiver_batches.size();
+}
+
+void phys_obj::dispatch_contact_events(size_t begin, size_t end)
+{
+    assert(begin <= end && end <= s_contact_receiver_batches.size());
+    Scoped_world_access access{ s_num_running_contact_dispatches, s_num_running_world_queries };
+    for (size_t i = begin; i < end; i++)
+    {
+        size_t events_begin{ i == 0 ? 0 : s_contact_receiver_batches[i - 1].second };
+        size_t events_end{ s_contact_receiver_batches[i].second };
+        s_contact_receiver_batches[i].first->on_contact_events(
+            std::span<const Contact_event>(s_sorted_contact_events.data() + events_begin,
+                                           events_end - events_begin));
+    }
+}
+
+phys_obj::Contact_event_buffer& phys_obj::get_thread_contact_event_buffer()
+{
+    thread_local Contact_event_buffer* t_buffer{ nullptr };
+    if (t_buffer == nullptr)
+    {
+        // Register new buffer for this thread.
+        auto buffer{ std::make_unique<Contact_event_buffer>() };
+        buffer->events.reserve(k_contact_events_per_thread);
+
+        std::lock_guard<std::mutex> lock{ s_contact_event_buffers_mutex };
+        t_buffer = buffer.get();
+        s_contact_event_buffers.emplace_back(std::move(buffer));
+
+        // @NOTE: Only if more threads record events than `set_references()`
+        //   was told about.
+        reserve_collected_contact_events(s_contact_event_buffers.size());
+    }
+    return *t_buffer;
+}
+
+// @NOTE: Call with `s_contact_event_buffers_mutex` locked.
+void phys_obj::reserve_collected_contact_events(size_t num_buffers)
+{
+    size_t capacity{ k_contact_events_per_thread * std::max<size_t>(1, num_buffers) };
+    s_collected_contact_events.reserve(capacity);
+    s_sorted_contact_events.reserve(capacity);
+    s_contact_receiver_batches.reserve(capacity);
+}
+
+void phys_obj::push_contact_event(Contact_event_buffer& buffer,
+                                  uint32_t body_idx,
+                                  Contact_event&& event)
+{
+    auto receiver{ s_contact_receivers_by_body_idx[body_idx].load(std::memory_order_relaxed) };
+    if (receiver == nullptr)
     {
-        auto& transform_b{
-            m_transform_triple_buffer[(buffer_offset_copy + k_read_b_offset) % k_num_buffers] };
+        return;
+    }
 
-        // @INCOMPLETE: Truncated data (if using double real JPH::RVec3).
-        pos[0] = transform_b.position[0];
-        pos[1] = transform_b.position[1];
-        pos[2] = transform_b.position[2];
+    if (buffer.events.size() >= k_contact_events_per_thread)
+    {
+        buffer.num_dropped++;
+        return;
+    }
+    buffer.events.push_back({ receiver, std::move(event) });
+}
 
-        glm_quat_copy(transform_b.rotation, rot);
+// Transform_holder.
+phys_obj::Transform_holder::Transform_holder(
+    bool interpolate,
+    const Query_physics_transform_ifc& physics_transform_ref)
+    : m_physics_transform_ref(&physics_transform_ref)
+    , m_body_id(physics_transform_ref.get_body_id())
+{
+    // @INCOMPLETE: Truncated data (if using double real JPH::RVec3).
+    auto initial_transform{ m_physics_transform_ref->query_physics_transform() };
+    float_t position[3]{
+        static_cast<float_t>(initial_transform.position[0]),
+        static_cast<float_t>(initial_transform.position[1]),
+        static_cast<float_t>(initial_transform.position[2]) };
+    m_store_idx = world_sim::Transform_store::allocate_one(interpolate,
+                                                           position,
+                                                           initial_transform.rotation,
+                                                           initial_transform.scale);
 
-        glm_vec3_copy(transform_b.scale, sca);
+    // Register for transform propagation.
+    Transform_holder* expected{ nullptr };
+    if (!s_transform_holders_by_body_idx[m_body_id.GetIndex()]
+            .compare_exchange_strong(expected, this))
+    {
+        // Only one transform holder per body is supported.
+        assert(false);
     }
+}
+
+phys_obj::Transform_holder::~Transform_holder()
+{
+    Transform_holder* expected{ this };
+    s_transform_holders_by_body_idx[m_body_id.GetIndex()]
+        .compare_exchange_strong(expected, nullptr);
+
+    world_sim::Transform_store::destroy_one(m_store_idx);
+}
 
-    // Write transform.
-    glm_translate_make(out_transform, pos);
-    glm_quat_rotate(out_transform, rot, out_transform);
-    glm_scale(out_transform, sca);
+void phys_obj::Transform_holder::set_interpolate(bool interpolate)
+{
+    world_sim::Transform_store::set_interpolate(m_store_idx, interpolate);
+}
+
+void phys_obj::Transform_holder::update_physics_transform()
+{
+    // @INCOMPLETE: Truncated data (if using double real JPH::RVec3).
+    auto transform{ m_physics_transform_ref->query_physics_transform() };
+    float_t position[3]{
+        static_cast<float_t>(transform.position[0]),
+        static_cast<float_t>(transform.position[1]),
+        static_cast<float_t>(transform.position[2]) };
+    world_sim::Transform_store::write_transform(m_store_idx,
+                                                position,
+                                                transform.rotation,
+                                                transform.scale);
+}
+
+void phys_obj::Transform_holder::read_current_transform(mat4& out_transform, float_t t)
+{
+    world_sim::Transform_store::read_transform(m_store_idx, t, out_transform);
 }
 
 // Actors.
@@ -118,56 +630,44 @@ phys_obj::Actor_kinematic::Actor_kinematic(JPH::RVec3 position,
     assert(!shape_params.empty());
 
     // Create shapes.
-    std::vector<Shape_const_reference> shapes;
-    shapes.reserve(shape_params.size());
-    for (auto& shape_param : shape_params)
-    {
-        shapes.emplace_back(
-            create_shape(shape_param.shape_type,
-                         shape_param.shape_params));
-    }
-
-    assert(shapes.size() == shape_params.size());
-
-    if (shapes.size() == 1)
+    if (shape_params.size() == 1)
     {
         // Single shape.
         // @NOTE: For debug just make sure that the transform is identity.
         //   FYI: Normally the 
         assert(shape_params[0].local_position.IsNearZero());
         assert(shape_params[0].local_rotation.IsClose(JPH::Quat::sIdentity()));
-        m_shape = shapes[0];
+        m_shape = create_shape(shape_params[0].shape_type,
+                               shape_params[0].shape_params);
     }
     else
     {
         // Compound shape.
-        JPH::StaticCompoundShapeSettings compound_settings;
-        for (size_t i = 0; i < shape_params.size(); i++)
-        {
-            auto& shape_param{ shape_params[i] };
-            compound_settings.AddShape(shape_param.local_position,
-                                       shape_param.local_rotation,
-                                       shapes[i]);
-        }
-        m_shape = compound_settings.Create().Get();
+        m_shape = create_compound_shape(shape_params);
     }
 
     // Create kinematic body.
+    // @NOTE: Only the body gets created here (cheap, and the body ID is usable
+    //   right away). Inserting into the broad phase is deferred to
+    //   `add_pending_bodies()` so that all of a tick's spawns go in one batch.
     assert(s_body_interface_ptr != nullptr);
-    assert(s_job_system_ptr != nullptr);
-    JPH::JobHandle handle =
-        s_job_system_ptr->CreateJob("CreateAndAddBody", JPH::ColorArg::sGreen, [&]() {
-            m_body_id =
-                s_body_interface_ptr->CreateAndAddBody(
-                    JPH::BodyCreationSettings(m_shape,
-                                            position,
-                                            rotation,
-                                            JPH::EMotionType::Kinematic,
-                                            Layers::MOVING),
-                    JPH::EActivation::Activate);
-        });
-    while (!handle.IsDone())
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    JPH::Body* body{
+        s_body_interface_ptr->CreateBody(
+            JPH::BodyCreationSettings(m_shape,
+                                      position,
+                                      rotation,
+                                      JPH::EMotionType::Kinematic,
+                                      Layers::MOVING)) };
+    if (body == nullptr)
+    {
+        // Ran out of bodies.
+        assert(false);
+        return;
+    }
+    m_body_id = body->GetID();
+
+    std::lock_guard<std::mutex> lock{ s_pending_add_bodies_mutex };
+    s_pending_add_body_ids.emplace_back(m_body_id);
 }
 
 phys_obj::Actor_kinematic::~Actor_kinematic()
@@ -177,12 +677,31 @@ phys_obj::Actor_kinematic::~Actor_kinematic()
     //   Essentially, the shape ref should still be connected if this is the
     //   owning object. If it is, then it's responsible for removing the physics
     //   body.  -Thea 2025/03/31
-    if (m_shape != nullptr)
+    if (m_shape != nullptr && !m_body_id.IsInvalid())
     {
-        s_body_interface_ptr->RemoveBody(m_body_id);
+        unsubscribe_contact_events(m_body_id);
+        remove_and_destroy_body(m_body_id);
     }
 }
 
+phys_obj::Actor_kinematic::Actor_kinematic(Actor_kinematic&& other) noexcept
+    : m_shape(std::move(other.m_shape))
+    , m_body_id(other.m_body_id)
+{
+    other.m_body_id = JPH::BodyID();
+    rebind_transform_holder(m_body_id, *this);
+}
+
+phys_obj::Actor_kinematic& phys_obj::Actor_kinematic::operator=(Actor_kinematic&& other) noexcept
+{
+    // @NOTE: Swap so that `other` removes this actor's old body.
+    std::swap(m_shape, other.m_shape);
+    std::swap(m_body_id, other.m_body_id);
+    rebind_transform_holder(m_body_id, *this);
+    rebind_transform_holder(other.m_body_id, other);
+    return *this;
+}
+
 void phys_obj::Actor_kinematic::get_position_and_rotation(JPH::RVec3& out_position,
                                                           JPH::Quat& out_rotation) const
 {
@@ -197,6 +716,7 @@ void phys_obj::Actor_kinematic::set_transform(JPH::RVec3Arg position, JPH::QuatA
                                                  position,
                                                  rotation,
                                                  JPH::EActivation::DontActivate);
+    mark_body_moved(m_body_id);
 }
 
 void phys_obj::Actor_kinematic::move_kinematic(JPH::RVec3Arg position, JPH::QuatArg rotation)
@@ -204,7 +724,7 @@ void phys_obj::Actor_kinematic::move_kinematic(JPH::RVec3Arg position, JPH::Quat
     s_body_interface_ptr->MoveKinematic(m_body_id,
                                         position,
                                         rotation,
-                                        k_world_sim_delta_time);
+                                        s_tick_delta_time.load(std::memory_order_relaxed));
 }
 
 phys_obj::Transform_decomposed phys_obj::Actor_kinematic::query_physics_transform() const
@@ -252,6 +772,8 @@ phys_obj::Actor_character_controller::Actor_character_controller(
     s_body_interface_ptr->SetMotionQuality(m_character_controller->GetBodyID(),
                                            JPH::EMotionQuality::Discrete);
 
+    s_char_ctrller_types_by_body_idx[m_character_controller->GetBodyID().GetIndex()]
+        .store(type_flags, std::memory_order_relaxed);
     m_character_controller->AddToPhysicsSystem(JPH::EActivation::Activate);
 }
 
@@ -261,13 +783,47 @@ phys_obj::Actor_character_controller::~Actor_character_controller()
     //   wrapper will remove the character controller from the physics system.
     if (m_character_controller != nullptr)
     {
+        unsubscribe_contact_events(m_character_controller->GetBodyID());
+        s_char_ctrller_types_by_body_idx[m_character_controller->GetBodyID().GetIndex()]
+            .store(ACTOR_CC_TYPE_INVALID, std::memory_order_relaxed);
         m_character_controller->RemoveFromPhysicsSystem();
     }
 }
 
+phys_obj::Actor_character_controller::Actor_character_controller(
+    Actor_character_controller&& other) noexcept
+    : m_type(other.m_type)
+    , m_shape(std::move(other.m_shape))
+    , m_character_controller(std::move(other.m_character_controller))
+{
+    if (m_character_controller != nullptr)
+    {
+        rebind_transform_holder(m_character_controller->GetBodyID(), *this);
+    }
+}
+
+phys_obj::Actor_character_controller& phys_obj::Actor_character_controller::operator=(
+    Actor_character_controller&& other) noexcept
+{
+    // @NOTE: Swap so that `other` removes this actor's old character controller.
+    std::swap(m_type, other.m_type);
+    std::swap(m_shape, other.m_shape);
+    std::swap(m_character_controller, other.m_character_controller);
+    if (m_character_controller != nullptr)
+    {
+        rebind_transform_holder(m_character_controller->GetBodyID(), *this);
+    }
+    if (other.m_character_controller != nullptr)
+    {
+        rebind_transform_holder(other.m_character_controller->GetBodyID(), other);
+    }
+    return *this;
+}
+
 void phys_obj::Actor_character_controller::set_position(JPH::RVec3Arg position)
 {
     m_character_controller->SetPosition(position);
+    mark_body_moved(m_character_controller->GetBodyID());
 }
 
 void phys_obj::Actor_character_controller::move(JPH::Vec3Arg velocity)
@@ -290,9 +846,1164 @@ phys_obj::Transform_decomposed phys_obj::Actor_character_controller::query_physi
 }
 
 
-// Helpers.
-phys_obj::Shape_const_reference phys_obj::create_shape(Shape_type shape_type,
-                                                       Shape_params_ptr shape_params)
+void phys_obj::rebind_transform_holder(JPH::BodyID body_id,
+                                       const Query_physics_transform_ifc& physics_transform_ref)
+{
+    if (body_id.IsInvalid())
+    {
+        return;
+    }
+
+    if (auto holder = s_transform_holders_by_body_idx[body_id.GetIndex()].load())
+    {
+        holder->set_physics_transform_ref(physics_transform_ref);
+    }
+}
+
+// Trigger.
+namespace phys_obj
+{
+
+// Rejects everything except character controllers of the sensed types
+// before the narrow phase.
+class Trigger_body_filter : public JPH::BodyFilter
+{
+public:
+    Trigger_body_filter(Actor_char_ctrller_type_e sensing_type_flags)
+        : m_sensing_type_flags(sensing_type_flags)
+    {
+    }
+
+    bool ShouldCollide(const JPH::BodyID& body_id) const override
+    {
+        return (s_char_ctrller_types_by_body_idx[body_id.GetIndex()]
+                    .load(std::memory_order_relaxed) & m_sensing_type_flags) != 0;
+    }
+
+private:
+    Actor_char_ctrller_type_e m_sensing_type_flags;
+};
+
+// Appends the body of every hit (w/ duplicates) into a reserved vector.
+class Trigger_overlap_collector : public JPH::CollideShapeCollector
+{
+public:
+    Trigger_overlap_collector(std::vector<JPH::BodyID>& out_body_ids)
+        : m_out_body_ids(out_body_ids)
+    {
+    }
+
+    void AddHit(const JPH::CollideShapeResult& result) override
+    {
+        if (m_out_body_ids.size() >= k_max_trigger_overlaps)
+        {
+            std::cerr << "WARNING: Trigger overlaps more than " << k_max_trigger_overlaps << " bodies." << std::endl;
+            ForceEarlyOut();
+            return;
+        }
+        m_out_body_ids.emplace_back(result.mBodyID2);
+    }
+
+private:
+    std::vector<JPH::BodyID>& m_out_body_ids;
+};
+
+}  // namespace phys_obj
+
+phys_obj::Trigger_kinematic::Trigger_kinematic(JPH::RVec3 position,
+                                               JPH::Quat rotation,
+                                               Actor_char_ctrller_type_e sensing_type_flags,
+                                               Shape_params_box&& volume_params)
+    : m_sensing_type_flags(sensing_type_flags)
+    , m_position(position)
+    , m_rotation(rotation)
+{
+    m_trigger_volume = create_shape(Shape_type::SHAPE_TYPE_BOX, &volume_params);
+
+    m_overlapping.reserve(k_max_trigger_overlaps);
+    m_prev_overlapping.reserve(k_max_trigger_overlaps);
+    m_entered.reserve(k_max_trigger_overlaps);
+    m_stayed.reserve(k_max_trigger_overlaps);
+    m_exited.reserve(k_max_trigger_overlaps);
+
+    std::lock_guard<std::mutex> lock{ s_triggers_mutex };
+    m_registry_idx = s_triggers.size();
+    s_triggers.emplace_back(this);
+}
+
+phys_obj::Trigger_kinematic::Trigger_kinematic(Trigger_kinematic&& other) noexcept
+    : m_sensing_type_flags(other.m_sensing_type_flags)
+    , m_trigger_volume(std::move(other.m_trigger_volume))
+    , m_position(other.m_position)
+    , m_rotation(other.m_rotation)
+    , m_registry_idx(other.m_registry_idx)
+    , m_overlapping(std::move(other.m_overlapping))
+    , m_prev_overlapping(std::move(other.m_prev_overlapping))
+    , m_entered(std::move(other.m_entered))
+    , m_stayed(std::move(other.m_stayed))
+    , m_exited(std::move(other.m_exited))
+{
+    // @NOTE: Moved-from trigger isn't registered anymore.
+    other.m_trigger_volume = nullptr;
+    rebind_registry_entry();
+}
+
+phys_obj::Trigger_kinematic& phys_obj::Trigger_kinematic::operator=(
+    Trigger_kinematic&& other) noexcept
+{
+    // @NOTE: Swap so that `other` unregisters this trigger's old entry.
+    std::swap(m_sensing_type_flags, other.m_sensing_type_flags);
+    std::swap(m_trigger_volume, other.m_trigger_volume);
+    std::swap(m_position, other.m_position);
+    std::swap(m_rotation, other.m_rotation);
+    std::swap(m_registry_idx, other.m_registry_idx);
+    std::swap(m_overlapping, other.m_overlapping);
+    std::swap(m_prev_overlapping, other.m_prev_overlapping);
+    std::swap(m_entered, other.m_entered);
+    std::swap(m_stayed, other.m_stayed);
+    std::swap(m_exited, other.m_exited);
+    rebind_registry_entry();
+    other.rebind_registry_entry();
+    return *this;
+}
+
+phys_obj::Trigger_kinematic::~Trigger_kinematic()
+{
+    if (m_trigger_volume == nullptr)
+    {
+        // Moved from.
+        return;
+    }
+
+    // Swap-remove from the registry.
+    std::lock_guard<std::mutex> lock{ s_triggers_mutex };
+    assert(s_triggers[m_registry_idx] == this);
+    s_triggers[m_registry_idx] = s_triggers.back();
+    s_triggers[m_registry_idx]->m_registry_idx = m_registry_idx;
+    s_triggers.pop_back();
+}
+
+void phys_obj::Trigger_kinematic::set_sensing_type_flags(Actor_char_ctrller_type_e sensing_type_flags)
+{
+    m_sensing_type_flags = sensing_type_flags;
+}
+
+void phys_obj::Trigger_kinematic::set_transform(JPH::RVec3Arg position, JPH::QuatArg rotation)
+{
+    m_position = position;
+    m_rotation = rotation;
+}
+
+void phys_obj::Trigger_kinematic::update_overlaps()
+{
+    std::swap(m_overlapping, m_prev_overlapping);
+    m_overlapping.clear();
+
+    Trigger_overlap_collector collector{ m_overlapping };
+    s_physics_system->GetNarrowPhaseQuery().CollideShape(
+        m_trigger_volume,
+        JPH::Vec3::sReplicate(1.0f),
+        JPH::RMat44::sRotationTranslation(m_rotation, m_position)
+            .PreTranslated(m_trigger_volume->GetCenterOfMass()),
+        JPH::CollideShapeSettings{},
+        JPH::RVec3::sZero(),
+        collector,
+        JPH::SpecifiedBroadPhaseLayerFilter{ Broad_phase_layers::MOVING },
+        JPH::SpecifiedObjectLayerFilter{ Layers::MOVING },
+        Trigger_body_filter{ m_sensing_type_flags });
+
+    // Sorted, unique lists so that the deltas are plain set operations.
+    std::sort(m_overlapping.begin(), m_overlapping.end());
+    m_overlapping.erase(std::unique(m_overlapping.begin(), m_overlapping.end()),
+                        m_overlapping.end());
+
+    m_entered.clear();
+    m_stayed.clear();
+    m_exited.clear();
+    std::set_difference(m_overlapping.begin(), m_overlapping.end(),
+                        m_prev_overlapping.begin(), m_prev_overlapping.end(),
+                        std::back_inserter(m_entered));
+    std::set_intersection(m_overlapping.begin(), m_overlapping.end(),
+                          m_prev_overlapping.begin(), m_prev_overlapping.end(),
+                          std::back_inserter(m_stayed));
+    std::set_difference(m_prev_overlapping.begin(), m_prev_overlapping.end(),
+                        m_overlapping.begin(), m_overlapping.end(),
+                        std::back_inserter(m_exited));
+}
+
+void phys_obj::Trigger_kinematic::rebind_registry_entry()
+{
+    if (m_trigger_volume == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock{ s_triggers_mutex };
+    s_triggers[m_registry_idx] = this;
+}
+
+size_t phys_obj::get_num_triggers()
+{
+    std::lock_guard<std::mutex> lock{ s_triggers_mutex };
+    return s_triggers.size();
+}
+
+void phys_obj::update_triggers(size_t begin, size_t end)
+{
+    assert(begin <= end && end <= s_triggers.size());
+    Scoped_world_access access{ s_num_running_world_queries, s_num_running_contact_dispatches };
+    for (size_t i = begin; i < end; i++)
+    {
+        s_triggers[i]->update_overlaps();
+    }
+}
+
+// Scene queries.
+namespace phys_obj
+{
+
+static_assert(k_scene_query_layer_non_moving == (1 << Layers::NON_MOVING));
+static_assert(k_scene_query_layer_moving == (1 << Layers::MOVING));
+static_assert(k_scene_query_layer_hit_hurt_box == (1 << Layers::HIT_HURT_BOX));
+
+// @NOTE: Object layers and broad phase layers map 1:1.
+class Scene_query_broad_phase_layer_filter : public JPH::BroadPhaseLayerFilter
+{
+public:
+    Scene_query_broad_phase_layer_filter(scene_query_layer_flags_t layers)
+        : m_layers(layers)
+    {
+    }
+
+    bool ShouldCollide(JPH::BroadPhaseLayer layer) const override
+    {
+        return (m_layers & (1 << static_cast<JPH::BroadPhaseLayer::Type>(layer))) != 0;
+    }
+
+private:
+    scene_query_layer_flags_t m_layers;
+};
+
+class Scene_query_object_layer_filter : public JPH::ObjectLayerFilter
+{
+public:
+    Scene_query_object_layer_filter(scene_query_layer_flags_t layers)
+        : m_layers(layers)
+    {
+    }
+
+    bool ShouldCollide(JPH::ObjectLayer layer) const override
+    {
+        return (m_layers & (1 << layer)) != 0;
+    }
+
+private:
+    scene_query_layer_flags_t m_layers;
+};
+
+}  // namespace phys_obj
+
+phys_obj::Scene_query_handle phys_obj::submit_ray_cast(JPH::RVec3Arg origin,
+                                                       JPH::Vec3Arg direction,
+                                                       scene_query_layer_flags_t layers,
+                                                       JPH::BodyID ignore_body_id)
+{
+    return submit_scene_query({
+        .type{ SCENE_QUERY_TYPE_RAY_CAST },
+        .layers{ layers },
+        .ignore_body_id{ ignore_body_id },
+        .position{ origin },
+        .rotation{ JPH::Quat::sIdentity() },
+        .direction{ direction },
+        .shape{ nullptr },
+    });
+}
+
+phys_obj::Scene_query_handle phys_obj::submit_shape_cast(const Shape_const_reference& shape,
+                                                         JPH::RVec3Arg position,
+                                                         JPH::QuatArg rotation,
+                                                         JPH::Vec3Arg direction,
+                                                         scene_query_layer_flags_t layers,
+                                                         JPH::BodyID ignore_body_id)
+{
+    assert(shape != nullptr);
+    return submit_scene_query({
+        .type{ SCENE_QUERY_TYPE_SHAPE_CAST },
+        .layers{ layers },
+        .ignore_body_id{ ignore_body_id },
+        .position{ position },
+        .rotation{ rotation },
+        .direction{ direction },
+        .shape{ shape },
+    });
+}
+
+bool phys_obj::get_scene_query_result(Scene_query_handle handle, Scene_query_result& out_result)
+{
+    if (!handle.is_valid() || handle.tick != s_scene_query_batch_tick)
+    {
+        return false;
+    }
+
+    assert(handle.idx < s_num_batched_scene_queries);
+    out_result = s_scene_query_results[handle.tick % 2][handle.idx];
+    return true;
+}
+
+size_t phys_obj::collect_scene_queries()
+{
+    // @NOTE: Gets called between the logic update and the next one, so
+    //   nothing is submitting right now.
+    s_scene_query_batch_tick = s_scene_query_submit_tick.fetch_add(1, std::memory_order_relaxed);
+    size_t num_submitted{ s_num_submitted_scene_queries.exchange(0, std::memory_order_relaxed) };
+    if (num_submitted > k_max_scene_queries_per_tick)
+    {
+        std::cerr << "WARNING: Dropped " << (num_submitted - k_max_scene_queries_per_tick) << " scene queries (batch full)." << std::endl;
+    }
+    s_num_batched_scene_queries = std::min(num_submitted, k_max_scene_queries_per_tick);
+    return s_num_batched_scene_queries;
+}
+
+void phys_obj::run_scene_queries(size_t begin, size_t end)
+{
+    assert(begin <= end && end <= s_num_batched_scene_queries);
+    Scoped_world_access access{ s_num_running_world_queries, s_num_running_contact_dispatches };
+    auto& requests{ s_scene_query_requests[s_scene_query_batch_tick % 2] };
+    auto& results{ s_scene_query_results[s_scene_query_batch_tick % 2] };
+    auto& narrow_phase_query{ s_physics_system->GetNarrowPhaseQuery() };
+
+    for (size_t i = begin; i < end; i++)
+    {
+        auto& request{ requests[i] };
+        auto& result{ results[i] };
+        result.has_hit = false;
+
+        Scene_query_broad_phase_layer_filter broad_phase_layer_filter{ request.layers };
+        Scene_query_object_layer_filter object_layer_filter{ request.layers };
+        JPH::IgnoreSingleBodyFilter ignore_body_filter{ request.ignore_body_id };
+
+        switch (request.type)
+        {
+            case SCENE_QUERY_TYPE_RAY_CAST:
+            {
+                JPH::RRayCast ray{ request.position, request.direction };
+                JPH::RayCastResult hit;
+                if (narrow_phase_query.CastRay(ray,
+                                               hit,
+                                               broad_phase_layer_filter,
+                                               object_layer_filter,
+                                               ignore_body_filter))
+                {
+                    result.has_hit = true;
+                    result.body_id = hit.mBodyID;
+                    result.fraction = hit.mFraction;
+                    result.position = ray.GetPointOnRay(hit.mFraction);
+
+                    JPH::BodyLockRead lock{ s_physics_system->GetBodyLockInterface(), hit.mBodyID };
+                    result.normal =
+                        (lock.Succeeded() ?
+                            lock.GetBody().GetWorldSpaceSurfaceNormal(hit.mSubShapeID2, result.position) :
+                            -request.direction.NormalizedOr(JPH::Vec3::sAxisY()));
+                }
+                break;
+            }
+
+            case SCENE_QUERY_TYPE_SHAPE_CAST:
+            {
+                JPH::ClosestHitCollisionCollector<JPH::CastShapeCollector> collector;
+                narrow_phase_query.CastShape(
+                    JPH::RShapeCast{ request.shape,
+                                     JPH::Vec3::sReplicate(1.0f),
+                                     JPH::RMat44::sRotationTranslation(request.rotation, request.position)
+                                         .PreTranslated(request.shape->GetCenterOfMass()),
+                                     request.direction },
+                    JPH::ShapeCastSettings{},
+                    JPH::RVec3::sZero(),
+                    collector,
+                    broad_phase_layer_filter,
+                    object_layer_filter,
+                    ignore_body_filter);
+                if (collector.HadHit())
+                {
+                    auto& hit{ collector.mHit };
+                    result.has_hit = true;
+                    result.body_id = hit.mBodyID2;
+                    result.fraction = hit.mFraction;
+                    result.position = JPH::RVec3(hit.mContactPointOn2);
+                    result.normal = -hit.mPenetrationAxis.NormalizedOr(JPH::Vec3::sAxisY());
+                }
+
+                // Let go of the shape.
+                request.shape = nullptr;
+                break;
+            }
+        }
+    }
+}
+
+phys_obj::Scene_query_handle phys_obj::submit_scene_query(Scene_query_request&& request)
+{
+    uint32_t idx{ s_num_submitted_scene_queries.fetch_add(1, std::memory_order_relaxed) };
+    if (idx >= k_max_scene_queries_per_tick)
+    {
+        // Batch is full.
+        return k_invalid_scene_query_handle;
+    }
+
+    uint64_t tick{ s_scene_query_submit_tick.load(std::memory_order_relaxed) };
+    s_scene_query_requests[tick % 2][idx] = std::move(request);
+    return { tick, idx };
+}
+
+// Hitboxes.
+phys_obj::Hitbox_ifc::Hitbox_ifc(Hitbox_callback_fn&& callback)
+    : m_callback(std::move(callback))
+{
+}
+
+phys_obj::Hitbox_ifc::~Hitbox_ifc()
+{
+    if (!m_body_id.IsInvalid())
+    {
+        remove_and_destroy_body(m_body_id);
+    }
+}
+
+void phys_obj::Hitbox_ifc::create_hitbox_body(Shape_const_reference shape,
+                                              JPH::RVec3Arg position,
+                                              JPH::QuatArg rotation)
+{
+    assert(m_body_id.IsInvalid());
+    m_shape = std::move(shape);
+
+    // @NOTE: Added along with the other pending bodies (see `Actor_kinematic`).
+    assert(s_body_interface_ptr != nullptr);
+    JPH::BodyCreationSettings settings{ m_shape,
+                                        position,
+                                        rotation,
+                                        JPH::EMotionType::Kinematic,
+                                        Layers::HIT_HURT_BOX };
+    settings.mUserData = reinterpret_cast<uint64_t>(this);
+    JPH::Body* body{ s_body_interface_ptr->CreateBody(settings) };
+    if (body == nullptr)
+    {
+        // Ran out of bodies.
+        assert(false);
+        return;
+    }
+    m_body_id = body->GetID();
+
+    std::lock_guard<std::mutex> lock{ s_pending_add_bodies_mutex };
+    s_pending_add_body_ids.emplace_back(m_body_id);
+}
+
+phys_obj::Hitbox_kinematic::Hitbox_kinematic(JPH::RVec3 position,
+                                             JPH::Quat rotation,
+                                             Shape_params_box&& volume_params,
+                                             Hitbox_callback_fn&& callback)
+    : Hitbox_ifc(std::move(callback))
+    , m_position(position)
+    , m_rotation(rotation)
+{
+    create_hitbox_body(create_shape(Shape_type::SHAPE_TYPE_BOX, &volume_params),
+                       position,
+                       rotation);
+}
+
+void phys_obj::Hitbox_kinematic::set_transform(JPH::RVec3Arg position, JPH::QuatArg rotation)
+{
+    m_position = position;
+    m_rotation = rotation;
+    update_hitbox_transform();
+}
+
+void phys_obj::Hitbox_kinematic::update_hitbox_transform()
+{
+    // @NOTE: Hitboxes never simulate, so don't wake the body up.
+    s_body_interface_ptr->SetPositionAndRotation(m_body_id,
+                                                 m_position,
+                                                 m_rotation,
+                                                 JPH::EActivation::DontActivate);
+}
+
+// Hurtboxes.
+namespace phys_obj
+{
+
+// Appends the body of every broadphase hit into a vector.
+class Combat_hitbox_body_collector : public JPH::CollideShapeBodyCollector
+{
+public:
+    Combat_hitbox_body_collector(std::vector<JPH::BodyID>& out_body_ids)
+        : m_out_body_ids(out_body_ids)
+    {
+    }
+
+    void AddHit(const JPH::BodyID& body_id) override
+    {
+        m_out_body_ids.emplace_back(body_id);
+    }
+
+private:
+    std::vector<JPH::BodyID>& m_out_body_ids;
+};
+
+}  // namespace phys_obj
+
+phys_obj::Hurtbox_ifc::Hurtbox_ifc(Hurtbox_type_e type)
+    : m_type(type)
+{
+    m_swing_hit_hitboxes.reserve(k_max_hits_per_swing);
+    m_pending_hits.reserve(k_max_hits_per_swing);
+
+    std::lock_guard<std::mutex> lock{ s_hurtboxes_mutex };
+    m_registry_idx = s_hurtboxes.size();
+    s_hurtboxes.emplace_back(this);
+    s_active_hurtboxes.reserve(s_hurtboxes.capacity());
+}
+
+phys_obj::Hurtbox_ifc::~Hurtbox_ifc()
+{
+    // Swap-remove from the registry.
+    std::lock_guard<std::mutex> lock{ s_hurtboxes_mutex };
+    assert(s_hurtboxes[m_registry_idx] == this);
+    s_hurtboxes[m_registry_idx] = s_hurtboxes.back();
+    s_hurtboxes[m_registry_idx]->m_registry_idx = m_registry_idx;
+    s_hurtboxes.pop_back();
+}
+
+void phys_obj::Hurtbox_ifc::begin_swing()
+{
+    m_swing_hit_hitboxes.clear();
+    m_pending_hits.clear();
+}
+
+void phys_obj::Hurtbox_ifc::prepare_query()
+{
+    update_hurtbox_transform();
+    m_query_bounds = calc_query_bounds();
+    m_candidate_hitbox_idxs = {};
+}
+
+void phys_obj::Hurtbox_ifc::query_intersecting_hitboxes()
+{
+    query_hitboxes();
+
+    // Remember the hits for the rest of the swing.
+    for (auto hitbox : m_pending_hits)
+    {
+        m_swing_hit_hitboxes.insert(std::upper_bound(m_swing_hit_hitboxes.begin(),
+                                                     m_swing_hit_hitboxes.end(),
+                                                     hitbox),
+                                    hitbox);
+    }
+}
+
+void phys_obj::Hurtbox_ifc::query_hitboxes()
+{
+    if (m_query_shape != nullptr)
+    {
+        collide_hitboxes(m_query_shape, m_query_transform);
+    }
+}
+
+JPH::AABox phys_obj::Hurtbox_ifc::calc_query_bounds() const
+{
+    if (m_query_shape == nullptr)
+    {
+        // Empty (overlaps nothing).
+        return JPH::AABox{};
+    }
+    return m_query_shape->GetWorldSpaceBounds(m_query_transform, JPH::Vec3::sReplicate(1.0f));
+}
+
+void phys_obj::Hurtbox_ifc::collide_hitboxes(const JPH::Shape* shape,
+                                             JPH::RMat44Arg center_of_mass_transform)
+{
+    for (auto hitbox_idx : m_candidate_hitbox_idxs)
+    {
+        auto& candidate{ s_combat_hitboxes[hitbox_idx] };
+        if (is_hit_this_swing(candidate.hitbox))
+        {
+            continue;
+        }
+
+        JPH::AnyHitCollisionCollector<JPH::CollideShapeCollector> collector;
+        candidate.shape.CollideShape(shape,
+                                     JPH::Vec3::sReplicate(1.0f),
+                                     center_of_mass_transform,
+                                     JPH::CollideShapeSettings{},
+                                     JPH::RVec3::sZero(),
+                                     collector);
+        if (collector.HadHit())
+        {
+            add_pending_hit(candidate.hitbox);
+        }
+    }
+}
+
+void phys_obj::Hurtbox_ifc::cast_hitboxes(const JPH::Shape* shape,
+                                          JPH::RMat44Arg center_of_mass_start,
+                                          JPH::Vec3Arg direction)
+{
+    JPH::RShapeCast shape_cast{ shape,
+                                JPH::Vec3::sReplicate(1.0f),
+                                center_of_mass_start,
+                                direction };
+    for (auto hitbox_idx : m_candidate_hitbox_idxs)
+    {
+        auto& candidate{ s_combat_hitboxes[hitbox_idx] };
+        if (is_hit_this_swing(candidate.hitbox))
+        {
+            continue;
+        }
+
+        JPH::AnyHitCollisionCollector<JPH::CastShapeCollector> collector;
+        candidate.shape.CastShape(shape_cast,
+                                  JPH::ShapeCastSettings{},
+                                  JPH::RVec3::sZero(),
+                                  collector);
+        if (collector.HadHit())
+        {
+            add_pending_hit(candidate.hitbox);
+        }
+    }
+}
+
+void phys_obj::Hurtbox_ifc::add_pending_hit(Hitbox_ifc* hitbox)
+{
+    if (m_swing_hit_hitboxes.size() + m_pending_hits.size() >= k_max_hits_per_swing)
+    {
+        std::cerr << "WARNING: Hurtbox hit more than " << k_max_hits_per_swing << " hitboxes in one swing." << std::endl;
+        return;
+    }
+    m_pending_hits.emplace_back(hitbox);
+}
+
+bool phys_obj::Hurtbox_ifc::is_hit_this_swing(Hitbox_ifc* hitbox) const
+{
+    return (std::binary_search(m_swing_hit_hitboxes.begin(),
+                               m_swing_hit_hitboxes.end(),
+                               hitbox) ||
+            std::find(m_pending_hits.begin(),
+                      m_pending_hits.end(),
+                      hitbox) != m_pending_hits.end());
+}
+
+void phys_obj::Hurtbox_ifc::report_pending_hits()
+{
+    for (auto hitbox : m_pending_hits)
+    {
+        hitbox->report_hit(this);
+    }
+    m_pending_hits.clear();
+}
+
+phys_obj::Hurtbox_blade::Hurtbox_blade(JPH::Vec3 blade_base,
+                                       JPH::Vec3 blade_tip,
+                                       float_t blade_radius)
+    : Hurtbox_ifc(HURTBOX_TYPE_METAL_BLADE)
+    , m_blade_center((blade_base + blade_tip) * 0.5f)
+    , m_blade_rotation(JPH::Quat::sFromTo(JPH::Vec3::sAxisY(),
+                                          (blade_tip - blade_base).Normalized()))
+    , m_blade_base(blade_base)
+    , m_blade_tip(blade_tip)
+    , m_blade_radius(blade_radius)
+    , m_blade_reach(std::max(blade_base.Length(), blade_tip.Length()))
+    , m_blade_bound_radius(m_blade_center.Length() + (blade_tip - blade_base).Length() * 0.5f)
+{
+    assert(!(blade_tip - blade_base).IsNearZero());
+    assert(blade_radius > 0.0f);
+
+    // @NOTE: Created once (and shared between blades of the same size through
+    //   the shape cache) instead of building a swept shape every tick.
+    Shape_params_capsule capsule_params{
+        .radius{ blade_radius },
+        .half_height{ (blade_tip - blade_base).Length() * 0.5f },
+    };
+    m_query_shape = create_shape(Shape_type::SHAPE_TYPE_CAPSULE, &capsule_params);
+
+    // Fat capsules (same core segment) for the fast swings.
+    for (uint32_t i = 0; i < k_num_fat_capsules; i++)
+    {
+        capsule_params.radius = blade_radius * static_cast<float_t>(2u << i);
+        m_fat_capsule_shapes[i] = create_shape(Shape_type::SHAPE_TYPE_CAPSULE, &capsule_params);
+    }
+}
+
+void phys_obj::Hurtbox_blade::set_bone_transform(JPH::RVec3Arg position, JPH::QuatArg rotation)
+{
+    m_bone_transform.position = position;
+    m_bone_transform.rotation = rotation;
+}
+
+void phys_obj::Hurtbox_blade::begin_swing()
+{
+    Hurtbox_ifc::begin_swing();
+    m_has_sweep_from = false;
+}
+
+void phys_obj::Hurtbox_blade::set_active(bool active)
+{
+    Hurtbox_ifc::set_active(active);
+    if (!active)
+    {
+        // Don't sweep across the time the blade was inactive.
+        m_has_sweep_from = false;
+    }
+}
+
+void phys_obj::Hurtbox_blade::update_hurtbox_transform()
+{
+    // Sweep from where the last sweep ended to the current bone transform.
+    m_sweep_from = (m_has_sweep_from ? m_sweep_to : m_bone_transform);
+    m_sweep_to = m_bone_transform;
+    m_has_sweep_from = true;
+
+    // Enough steps that no point of the blade moves more than one capsule
+    // radius per step.
+    // @NOTE: Bounds the travel of the interpolated transforms (linear
+    //   position, SLERP rotation) by the bone's travel plus the arc that the
+    //   farthest point of the blade rotates through, so the bound also holds
+    //   for swings whose tip comes back around.
+    float_t bone_travel{
+        static_cast<float_t>((m_sweep_to.position - m_sweep_from.position).Length()) };
+    float_t rotation_angle{
+        2.0f * std::acos(std::min(1.0f, std::abs(m_sweep_from.rotation.Dot(m_sweep_to.rotation)))) };
+    float_t max_travel{ bone_travel + rotation_angle * m_blade_reach };
+    float_t sweep_radius{ m_blade_radius };
+    m_sweep_shape = m_query_shape;
+    for (uint32_t i = 0; max_travel > sweep_radius * static_cast<float_t>(k_max_sweep_steps); i++)
+    {
+        if (i == k_num_fat_capsules)
+        {
+            // Too far for any capsule (e.g. a teleport). Only hit what's at
+            // the end of the swing.
+            m_sweep_shape = nullptr;
+            break;
+        }
+        sweep_radius = m_blade_radius * static_cast<float_t>(2u << i);
+        m_sweep_shape = m_fat_capsule_shapes[i];
+    }
+    float_t num_steps{ std::clamp(std::ceil(max_travel / sweep_radius),
+                                  1.0f,
+                                  static_cast<float_t>(k_max_sweep_steps)) };
+    m_num_sweep_steps = (m_sweep_shape == nullptr ? 0 : static_cast<uint32_t>(num_steps));
+    m_sweep_radius = sweep_radius;
+
+    m_query_transform = calc_blade_transform(m_sweep_to);
+}
+
+void phys_obj::Hurtbox_blade::query_hitboxes()
+{
+    if (m_num_sweep_steps == 0)
+    {
+        collide_hitboxes(m_query_shape, m_query_transform);
+        return;
+    }
+
+    // Chain of capsule casts along the swing.
+    // @NOTE: Casts only translate, so each step holds the rotation at its
+    //   start. Since no point of the blade moves more than one radius per
+    //   step, the blade's core segment stays inside the cast capsule during
+    //   the step (only the rim of the blade can graze past a hitbox). A fat
+    //   capsule also overlaps a bit around the blade, which is the price for
+    //   keeping fast swings at `k_max_sweep_steps` casts.
+    JPH::RMat44 step_from{ calc_blade_transform(m_sweep_from) };
+    for (uint32_t i = 1; i <= m_num_sweep_steps; i++)
+    {
+        float_t t{ static_cast<float_t>(i) / static_cast<float_t>(m_num_sweep_steps) };
+        JPH::RMat44 step_to{ calc_blade_transform(calc_sweep_transform(t)) };
+
+        JPH::Vec3 direction{ JPH::Vec3(step_to.GetTranslation() - step_from.GetTranslation()) };
+        if (direction.IsNearZero())
+        {
+            // Blade didn't move.
+            collide_hitboxes(m_sweep_shape, step_from);
+        }
+        else
+        {
+            cast_hitboxes(m_sweep_shape, step_from, direction);
+        }
+        step_from = step_to;
+    }
+}
+
+JPH::AABox phys_obj::Hurtbox_blade::calc_query_bounds() const
+{
+    if (m_num_sweep_steps == 0)
+    {
+        return Hurtbox_ifc::calc_query_bounds();
+    }
+
+    // @NOTE: During every cast of the chain, the center of the cast capsule
+    //   stays within the length of `m_blade_center` of the bone's (linear)
+    //   path, so all of the capsule stays within this radius of it.
+    float_t radius{ m_blade_bound_radius + m_sweep_radius };
+    JPH::AABox bounds{ JPH::Vec3(m_sweep_from.position), radius };
+    bounds.Encapsulate(JPH::AABox{ JPH::Vec3(m_sweep_to.position), radius });
+    return bounds;
+}
+
+phys_obj::Hurtbox_blade::Bone_transform phys_obj::Hurtbox_blade::calc_sweep_transform(float_t t) const
+{
+    return {
+        .position{ m_sweep_from.position + (m_sweep_to.position - m_sweep_from.position) * t },
+        .rotation{ m_sweep_from.rotation.SLERP(m_sweep_to.rotation, t) },
+    };
+}
+
+JPH::RMat44 phys_obj::Hurtbox_blade::calc_blade_transform(const Bone_transform& bone_transform) const
+{
+    return JPH::RMat44::sRotationTranslation(bone_transform.rotation * m_blade_rotation,
+                                             bone_transform.position +
+                                                 bone_transform.rotation * m_blade_center);
+}
+
+phys_obj::Hurtbox_kinematic::Hurtbox_kinematic(JPH::RVec3 position,
+                                               JPH::Quat rotation,
+                                               Shape_params_box&& volume_params)
+    : Hurtbox_ifc(HURTBOX_TYPE_HAZARD)
+    , m_position(position)
+    , m_rotation(rotation)
+{
+    m_query_shape = create_shape(Shape_type::SHAPE_TYPE_BOX, &volume_params);
+}
+
+void phys_obj::Hurtbox_kinematic::set_transform(JPH::RVec3Arg position, JPH::QuatArg rotation)
+{
+    m_position = position;
+    m_rotation = rotation;
+}
+
+void phys_obj::Hurtbox_kinematic::update_hurtbox_transform()
+{
+    m_query_transform =
+        JPH::RMat44::sRotationTranslation(m_rotation, m_position)
+            .PreTranslated(m_query_shape->GetCenterOfMass());
+}
+
+// Combat stage.
+size_t phys_obj::collect_active_hurtboxes()
+{
+    std::lock_guard<std::mutex> lock{ s_hurtboxes_mutex };
+    s_active_hurtboxes.clear();
+    for (auto hurtbox : s_hurtboxes)
+    {
+        if (hurtbox->get_active())
+        {
+            s_active_hurtboxes.emplace_back(hurtbox);
+        }
+    }
+    return s_active_hurtboxes.size();
+}
+
+void phys_obj::find_combat_candidates()
+{
+    Scoped_world_access access{ s_num_running_world_queries, s_num_running_contact_dispatches };
+
+    s_combat_hitbox_body_ids.clear();
+    s_combat_hitboxes.clear();
+    s_combat_pairs.clear();
+    s_combat_candidate_hitbox_idxs.clear();
+
+    JPH::AABox all_query_bounds;
+    for (auto hurtbox : s_active_hurtboxes)
+    {
+        hurtbox->prepare_query();
+        if (hurtbox->get_query_bounds().IsValid())
+        {
+            all_query_bounds.Encapsulate(hurtbox->get_query_bounds());
+        }
+    }
+    if (!all_query_bounds.IsValid())
+    {
+        // Nothing to query.
+        return;
+    }
+
+    // One broadphase pass over the hitbox layer.
+    Combat_hitbox_body_collector collector{ s_combat_hitbox_body_ids };
+    s_physics_system->GetBroadPhaseQuery().CollideAABox(
+        all_query_bounds,
+        collector,
+        JPH::SpecifiedBroadPhaseLayerFilter{ Broad_phase_layers::HIT_HURT_BOX },
+        JPH::SpecifiedObjectLayerFilter{ Layers::HIT_HURT_BOX });
+
+    for (auto body_id : s_combat_hitbox_body_ids)
+    {
+        JPH::BodyLockRead lock{ s_physics_system->GetBodyLockInterface(), body_id };
+        if (!lock.Succeeded())
+        {
+            continue;
+        }
+        auto& body{ lock.GetBody() };
+        auto hitbox{ reinterpret_cast<Hitbox_ifc*>(body.GetUserData()) };
+        if (hitbox != nullptr)
+        {
+            s_combat_hitboxes.push_back({ hitbox, body.GetTransformedShape(), body.GetWorldSpaceBounds() });
+        }
+    }
+
+    // Pair the hurtboxes with the hitboxes that their bounds overlap (sweep
+    // and prune along X).
+    // @NOTE: A pair gets found by whichever of the two starts first along X
+    //   (ties go to the hurtbox), so every pair gets found exactly once.
+    auto hitbox_min_x_less = [](const Combat_hitbox& a, const Combat_hitbox& b) {
+        return a.bounds.mMin.GetX() < b.bounds.mMin.GetX();
+    };
+    auto hurtbox_min_x_less = [](const Hurtbox_ifc* a, const Hurtbox_ifc* b) {
+        return a->get_query_bounds().mMin.GetX() < b->get_query_bounds().mMin.GetX();
+    };
+    std::sort(s_combat_hitboxes.begin(), s_combat_hitboxes.end(), hitbox_min_x_less);
+    std::sort(s_active_hurtboxes.begin(), s_active_hurtboxes.end(), hurtbox_min_x_less);
+
+    for (uint32_t hurtbox_idx = 0; hurtbox_idx < s_active_hurtboxes.size(); hurtbox_idx++)
+    {
+        auto& query_bounds{ s_active_hurtboxes[hurtbox_idx]->get_query_bounds() };
+        auto it{ std::lower_bound(s_combat_hitboxes.begin(),
+                                  s_combat_hitboxes.end(),
+                                  query_bounds.mMin.GetX(),
+                                  [](const Combat_hitbox& a, float_t x) { return a.bounds.mMin.GetX() < x; }) };
+        for (; it != s_combat_hitboxes.end() && it->bounds.mMin.GetX() <= query_bounds.mMax.GetX(); it++)
+        {
+            if (it->bounds.Overlaps(query_bounds))
+            {
+                s_combat_pairs.emplace_back(hurtbox_idx,
+                                            static_cast<uint32_t>(it - s_combat_hitboxes.begin()));
+            }
+        }
+    }
+    for (uint32_t hitbox_idx = 0; hitbox_idx < s_combat_hitboxes.size(); hitbox_idx++)
+    {
+        auto& bounds{ s_combat_hitboxes[hitbox_idx].bounds };
+        auto it{ std::upper_bound(s_active_hurtboxes.begin(),
+                                  s_active_hurtboxes.end(),
+                                  bounds.mMin.GetX(),
+                                  [](float_t x, const Hurtbox_ifc* a) { return x < a->get_query_bounds().mMin.GetX(); }) };
+        for (; it != s_active_hurtboxes.end() && (*it)->get_query_bounds().mMin.GetX() <= bounds.mMax.GetX(); it++)
+        {
+            if ((*it)->get_query_bounds().Overlaps(bounds))
+            {
+                s_combat_pairs.emplace_back(static_cast<uint32_t>(it - s_active_hurtboxes.begin()),
+                                            hitbox_idx);
+            }
+        }
+    }
+
+    // Hand each hurtbox its candidates.
+    std::sort(s_combat_pairs.begin(), s_combat_pairs.end());
+    for (auto& pair : s_combat_pairs)
+    {
+        s_combat_candidate_hitbox_idxs.emplace_back(pair.second);
+    }
+    size_t pair_idx{ 0 };
+    for (uint32_t hurtbox_idx = 0; hurtbox_idx < s_active_hurtboxes.size(); hurtbox_idx++)
+    {
+        size_t begin{ pair_idx };
+        while (pair_idx < s_combat_pairs.size() && s_combat_pairs[pair_idx].first == hurtbox_idx)
+        {
+            pair_idx++;
+        }
+        s_active_hurtboxes[hurtbox_idx]->set_candidate_hitboxes(
+            std::span<const uint32_t>(s_combat_candidate_hitbox_idxs.data() + begin, pair_idx - begin));
+    }
+}
+
+void phys_obj::query_active_hurtboxes(size_t begin, size_t end)
+{
+    assert(begin <= end && end <= s_active_hurtboxes.size());
+    Scoped_world_access access{ s_num_running_world_queries, s_num_running_contact_dispatches };
+    for (size_t i = begin; i < end; i++)
+    {
+        s_active_hurtboxes[i]->query_intersecting_hitboxes();
+    }
+}
+
+void phys_obj::report_combat_hits()
+{
+    // @NOTE: Single thread so that the hitbox callbacks don't need to be
+    //   thread safe.
+    for (auto hurtbox : s_active_hurtboxes)
+    {
+        hurtbox->report_pending_hits();
+    }
+}
+
+// Shape cache.
+phys_obj::Shape_cache_stats phys_obj::get_shape_cache_stats()
+{
+    std::lock_guard<std::mutex> lock{ s_shape_cache_mutex };
+
+    Shape_cache_stats stats{
+        .num_hits{ s_shape_cache_num_hits },
+        .num_misses{ s_shape_cache_num_misses },
+        .num_cached_shapes{ s_shape_cache.size() },
+        .num_shape_bytes{ 0 },
+        .num_key_bytes{ 0 },
+    };
+    for (auto& [key, shape] : s_shape_cache)
+    {
+        stats.num_shape_bytes += shape->GetStats().mSizeBytes;
+        stats.num_key_bytes += key.size();
+    }
+    return stats;
+}
+
+size_t phys_obj::purge_unused_cached_shapes()
+{
+    std::lock_guard<std::mutex> lock{ s_shape_cache_mutex };
+
+    size_t num_purged{ 0 };
+    for (auto it = s_shape_cache.begin(); it != s_shape_cache.end();)
+    {
+        if (it->second->GetRefCount() == 1)
+        {
+            // Only the cache is holding onto the shape.
+            it = s_shape_cache.erase(it);
+            num_purged++;
+        }
+        else
+        {
+            it++;
+        }
+    }
+    return num_purged;
+}
+
+// Helpers.
+void phys_obj::remove_and_destroy_body(JPH::BodyID body_id)
+{
+    bool was_pending{ false };
+    {
+        std::lock_guard<std::mutex> lock{ s_pending_add_bodies_mutex };
+        auto it{ std::find(s_pending_add_body_ids.begin(),
+                           s_pending_add_body_ids.end(),
+                           body_id) };
+        if (it != s_pending_add_body_ids.end())
+        {
+            // Never got added to the physics world.
+            *it = s_pending_add_body_ids.back();
+            s_pending_add_body_ids.pop_back();
+            was_pending = true;
+        }
+    }
+
+    if (!was_pending)
+    {
+        s_body_interface_ptr->RemoveBody(body_id);
+    }
+    s_body_interface_ptr->DestroyBody(body_id);
+}
+
+size_t phys_obj::get_shape_params_size(Shape_type shape_type)
+{
+    switch (shape_type)
+    {
+    case SHAPE_TYPE_BOX:              return sizeof(Shape_params_box);
+    case SHAPE_TYPE_SPHERE:           return sizeof(Shape_params_sphere);
+    case SHAPE_TYPE_CAPSULE:          return sizeof(Shape_params_capsule);
+    case SHAPE_TYPE_TAPERED_CAPSULE:  return sizeof(Shape_params_tapered_capsule);
+    case SHAPE_TYPE_CYLINDER:         return sizeof(Shape_params_cylinder);
+    case SHAPE_TYPE_TAPERED_CYLINDER: return sizeof(Shape_params_tapered_cylinder);
+    default:                          assert(false); return 0;
+    }
+}
+
+void phys_obj::append_shape_cache_key(std::string& in_out_key, const void* data, size_t size)
+{
+    in_out_key.append(reinterpret_cast<const char*>(data), size);
+}
+
+phys_obj::Shape_const_reference phys_obj::find_or_insert_cached_shape(
+    std::string&& key,
+    const std::function<Shape_const_reference()>& create_fn)
+{
+    {
+        std::lock_guard<std::mutex> lock{ s_shape_cache_mutex };
+        auto it{ s_shape_cache.find(key) };
+        if (it != s_shape_cache.end())
+        {
+            s_shape_cache_num_hits++;
+            return it->second;
+        }
+        s_shape_cache_num_misses++;
+    }
+
+    // Create outside of the lock (compounds look up their children).
+    Shape_const_reference shape{ create_fn() };
+    if (shape == nullptr)
+    {
+        assert(false);
+        return shape;
+    }
+
+    // @NOTE: If another thread inserted the same shape in the meantime, use
+    //   theirs so that the shape stays shared.
+    std::lock_guard<std::mutex> lock{ s_shape_cache_mutex };
+    return s_shape_cache.emplace(std::move(key), shape).first->second;
+}
+
+phys_obj::Shape_const_reference phys_obj::create_shape(Shape_type shape_type,
+                                                       Shape_params_ptr shape_params)
+{
+    assert(shape_params != nullptr);
+
+    std::string key;
+    append_shape_cache_key(key, &shape_type, sizeof(shape_type));
+    append_shape_cache_key(key, shape_params, get_shape_params_size(shape_type));
+
+    return find_or_insert_cached_shape(std::move(key), [&]() {
+        return create_shape_uncached(shape_type, shape_params);
+    });
+}
+
+phys_obj::Shape_const_reference phys_obj::create_compound_shape(
+    const std::vector<Shape_w_transform>& shape_params)
+{
+    // @NOTE: The child list is part of the key, so the children are looked up
+    //   (and shared) separately from the compound.
+    constexpr uint32_t k_compound_key_tag{ NUM_SHAPE_TYPES };
+    uint32_t num_children{ static_cast<uint32_t>(shape_params.size()) };
+
+    std::string key;
+    append_shape_cache_key(key, &k_compound_key_tag, sizeof(k_compound_key_tag));
+    append_shape_cache_key(key, &num_children, sizeof(num_children));
+    for (auto& shape_param : shape_params)
+    {
+        float_t local_position[3]{
+            shape_param.local_position.GetX(),
+            shape_param.local_position.GetY(),
+            shape_param.local_position.GetZ() };
+        float_t local_rotation[4]{
+            shape_param.local_rotation.GetX(),
+            shape_param.local_rotation.GetY(),
+            shape_param.local_rotation.GetZ(),
+            shape_param.local_rotation.GetW() };
+
+        append_shape_cache_key(key, &shape_param.shape_type, sizeof(shape_param.shape_type));
+        append_shape_cache_key(key,
+                               shape_param.shape_params,
+                               get_shape_params_size(shape_param.shape_type));
+        append_shape_cache_key(key, local_position, sizeof(local_position));
+        append_shape_cache_key(key, local_rotation, sizeof(local_rotation));
+    }
+
+    return find_or_insert_cached_shape(std::move(key), [&]() {
+        JPH::StaticCompoundShapeSettings compound_settings;
+        for (auto& shape_param : shape_params)
+        {
+            compound_settings.AddShape(shape_param.local_position,
+                                       shape_param.local_rotation,
+                                       create_shape(shape_param.shape_type,
+                                                    shape_param.shape_params));
+        }
+        return Shape_const_reference{ compound_settings.Create().Get() };
+    });
+}
+
+phys_obj::Shape_const_reference phys_obj::create_shape_uncached(Shape_type shape_type,
+                                                                Shape_params_ptr shape_params)
 {
     assert(shape_params != nullptr);
     Shape_const_reference shape{ nullptr };
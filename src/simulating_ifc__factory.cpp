@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cassert>
+#include <utility>  // std::swap
 #include <vector>
 #include "cglm/cglm.h"
 #include "pool_elem_key.h"
@@ -10,22 +11,75 @@
 
 // Behavior interface.
 simulating::Behavior_ifc::Behavior_ifc()
-    : m_input_data_key(Behavior_data_w_version::allocate_one())
+    : m_input_data_key(pool::invalid_key())
+{
+}
+
+simulating::Behavior_ifc::Behavior_ifc(Behavior_data_size_class input_size_class)
+    : m_input_data_key(Behavior_data_w_version::allocate_one(input_size_class))
 {
 }
 
 simulating::Behavior_ifc::~Behavior_ifc()
 {
-    Behavior_data_w_version::destroy_one(m_input_data_key);
+    if (!pool::is_invalid_key(m_input_data_key))
+    {
+        Behavior_data_w_version::destroy_one(m_input_data_key);
+    }
+}
+
+simulating::Behavior_ifc::Behavior_ifc(Behavior_ifc&& other) noexcept
+    : m_input_data_key(other.m_input_data_key)
+{
+    other.m_input_data_key = pool::invalid_key();
+}
+
+simulating::Behavior_ifc& simulating::Behavior_ifc::operator=(Behavior_ifc&& other) noexcept
+{
+    // @NOTE: Swap so that `other` frees this behavior's old data block.
+    std::swap(m_input_data_key, other.m_input_data_key);
+    return *this;
 }
 
 namespace simulating
 {
 
-static char s_behavior_data_block_collection__internal_data_chunk
-    [sizeof(Behavior_data_w_version) * k_num_max_behavior_data_blocks];
-static Behavior_data_w_version* s_behavior_data_block_collection{
-    reinterpret_cast<Behavior_data_w_version*>(s_behavior_data_block_collection__internal_data_chunk) };
+// Slab of blocks for a single size class.
+constexpr size_t k_num_behavior_data_buffers{ 2 };
+
+template<size_t Block_size>
+struct Behavior_data_slab
+{
+    alignas(k_behavior_data_alignment) uint8_t data[k_num_max_behavior_data_blocks][k_num_behavior_data_buffers][Block_size];
+    char block_collection__internal_data_chunk
+        [sizeof(Behavior_data_w_version) * k_num_max_behavior_data_blocks];
+};
+
+static Behavior_data_slab<get_size_class_block_size(BEHAVIOR_DATA_SIZE_CLASS_16)>  s_slab_16;
+static Behavior_data_slab<get_size_class_block_size(BEHAVIOR_DATA_SIZE_CLASS_32)>  s_slab_32;
+static Behavior_data_slab<get_size_class_block_size(BEHAVIOR_DATA_SIZE_CLASS_64)>  s_slab_64;
+static Behavior_data_slab<get_size_class_block_size(BEHAVIOR_DATA_SIZE_CLASS_128)> s_slab_128;
+static Behavior_data_slab<get_size_class_block_size(BEHAVIOR_DATA_SIZE_CLASS_256)> s_slab_256;
+static_assert(NUM_BEHAVIOR_DATA_SIZE_CLASSES == 5);
+
+static Behavior_data_w_version* s_behavior_data_block_collections[NUM_BEHAVIOR_DATA_SIZE_CLASSES]{
+    reinterpret_cast<Behavior_data_w_version*>(s_slab_16.block_collection__internal_data_chunk),
+    reinterpret_cast<Behavior_data_w_version*>(s_slab_32.block_collection__internal_data_chunk),
+    reinterpret_cast<Behavior_data_w_version*>(s_slab_64.block_collection__internal_data_chunk),
+    reinterpret_cast<Behavior_data_w_version*>(s_slab_128.block_collection__internal_data_chunk),
+    reinterpret_cast<Behavior_data_w_version*>(s_slab_256.block_collection__internal_data_chunk),
+};
+static uint8_t* s_behavior_data_slab_data[NUM_BEHAVIOR_DATA_SIZE_CLASSES]{
+    &s_slab_16.data[0][0][0],
+    &s_slab_32.data[0][0][0],
+    &s_slab_64.data[0][0][0],
+    &s_slab_128.data[0][0][0],
+    &s_slab_256.data[0][0][0],
+};
+
+static std::atomic<pool::elem_key_t> s_free_list_heads[NUM_BEHAVIOR_DATA_SIZE_CLASSES];
+
+static_assert(k_num_max_behavior_data_blocks <= k_behavior_data_block_idx_mask);
 
 }  // namespace simulating
 
@@ -39,88 +93,150 @@ void simulating::Behavior_data_w_version::initialize_data_pool()
         assert(false);
     }
 
-    for (uint32_t idx = 0; idx < k_num_max_behavior_data_blocks; idx++)
+    for (uint32_t size_class = 0; size_class < NUM_BEHAVIOR_DATA_SIZE_CLASSES; size_class++)
     {
-        s_behavior_data_block_collection[idx].reset(true);
+        size_t block_size{ get_size_class_block_size(static_cast<Behavior_data_size_class>(size_class)) };
+        for (uint32_t idx = 0; idx < k_num_max_behavior_data_blocks; idx++)
+        {
+            auto& block{ s_behavior_data_block_collections[size_class][idx] };
+            block.m_data =
+                s_behavior_data_slab_data[size_class] + idx * k_num_behavior_data_buffers * block_size;
+            block.m_size_class = static_cast<Behavior_data_size_class>(size_class);
+            block.reset(true);
+            block.m_next_free_idx =
+                (idx + 1 < k_num_max_behavior_data_blocks ? idx + 1 : k_no_free_idx);
+        }
+
+        s_free_list_heads[size_class] = pool::create_elem_key(0, 0);
     }
 }
 
-pool::elem_key_t simulating::Behavior_data_w_version::allocate_one()
+pool::elem_key_t simulating::Behavior_data_w_version::allocate_one(Behavior_data_size_class size_class)
 {
-    pool::elem_key_t ret{ pool::invalid_key() };
+    assert(size_class < NUM_BEHAVIOR_DATA_SIZE_CLASSES);
+    auto& free_list_head{ s_free_list_heads[size_class] };
+    auto block_collection{ s_behavior_data_block_collections[size_class] };
 
-    for (uint32_t idx = 0; idx < k_num_max_behavior_data_blocks; idx++)
+    // Pop block off free list.
+    uint32_t idx, tag;
+    pool::elem_key_t head{ free_list_head.load(std::memory_order_acquire) };
+    do
     {
-        auto& block{ s_behavior_data_block_collection[idx] };
-        uint8_t reserve_expect{ k_unreserved };
-        if (block.m_reserved.compare_exchange_strong(reserve_expect, k_setup_reservation))
+        pool::elem_key_extract_data(head, idx, tag);
+        if (idx == k_no_free_idx)
         {
-            // Setup reservation for data.
-            block.reset(false);
-            uint32_t version_num{ ++block.m_version };
-
-            // Complete reservation.
-            block.m_reserved.store(k_reserved);
+            // Out of blocks.
+            assert(false);
+            return pool::invalid_key();
+        }
 
-            ret = pool::create_elem_key(idx, version_num);
+        // @NOTE: If another thread pops this block first, `next_idx` may be
+        //   stale, but then the tag changed so the CAS fails.
+        uint32_t next_idx{
+            block_collection[idx].m_next_free_idx.load(std::memory_order_relaxed) };
+        if (free_list_head.compare_exchange_weak(head,
+                                                 pool::create_elem_key(next_idx, tag + 1),
+                                                 std::memory_order_acq_rel,
+                                                 std::memory_order_acquire))
+        {
             break;
         }
-    }
+    } while (true);
+
+    auto& block{ block_collection[idx] };
+    assert(block.m_reserved.load() == k_unreserved);
+
+    // Setup reservation for data.
+    block.m_reserved.store(k_setup_reservation);
+    block.reset(false);
+    uint32_t version_num{ ++block.m_version };
 
-    return ret;
+    // Complete reservation.
+    block.m_reserved.store(k_reserved);
+
+    return pool::create_elem_key((size_class << k_behavior_data_size_class_shift) | idx,
+                                 version_num);
 }
 
-bool simulating::Behavior_data_w_version::destroy_one(pool::elem_key_t key)
+void simulating::Behavior_data_w_version::flip_tick_epoch()
 {
-    uint32_t idx, version_num;
-    pool::elem_key_extract_data(key, idx, version_num);
+    s_tick_epoch++;
+}
 
-    if (idx >= k_num_max_behavior_data_blocks)
+bool simulating::Behavior_data_w_version::destroy_one(pool::elem_key_t key)
+{
+    Behavior_data_w_version* block_ptr;
+    if (!is_valid_key(key, block_ptr))
     {
         assert(false);
         return false;
     }
 
-    if (s_behavior_data_block_collection[idx].m_reserved.load() != k_reserved)
+    auto& block{ *block_ptr };
+    uint8_t reserve_expect{ k_reserved };
+    if (!block.m_reserved.compare_exchange_strong(reserve_expect, k_unreserved))
     {
+        // Destroyed by another thread.
         assert(false);
         return false;
     }
 
-    if (version_num != s_behavior_data_block_collection[idx].m_version)
+    // Push block onto free list.
+    auto& free_list_head{ s_free_list_heads[block.m_size_class] };
+    uint32_t idx{ static_cast<uint32_t>(block_ptr - s_behavior_data_block_collections[block.m_size_class]) };
+    uint32_t head_idx, tag;
+    pool::elem_key_t head{ free_list_head.load(std::memory_order_acquire) };
+    do
     {
-        assert(false);
-        return false;
-    }
+        pool::elem_key_extract_data(head, head_idx, tag);
+        block.m_next_free_idx.store(head_idx, std::memory_order_relaxed);
+    } while (!free_list_head.compare_exchange_weak(head,
+                                                   pool::create_elem_key(idx, tag + 1),
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire));
 
-    s_behavior_data_block_collection[idx].m_reserved.store(k_unreserved);
     return true;
 }
 
 simulating::Behavior_data_w_version* simulating::Behavior_data_w_version::get_one_from_key(pool::elem_key_t key)
 {
-    uint32_t idx, version_num;
-    pool::elem_key_extract_data(key, idx, version_num);
-
-    if (idx >= k_num_max_behavior_data_blocks)
+    Behavior_data_w_version* block_ptr;
+    if (!is_valid_key(key, block_ptr))
     {
         assert(false);
         return nullptr;
     }
 
-    if (s_behavior_data_block_collection[idx].m_reserved.load() != k_reserved)
+    return block_ptr;
+}
+
+bool simulating::Behavior_data_w_version::is_valid_key(pool::elem_key_t key,
+                                                       Behavior_data_w_version*& out_block)
+{
+    uint32_t packed_idx, version_num;
+    pool::elem_key_extract_data(key, packed_idx, version_num);
+
+    uint32_t size_class{ packed_idx >> k_behavior_data_size_class_shift };
+    uint32_t idx{ packed_idx & k_behavior_data_block_idx_mask };
+    if (size_class >= NUM_BEHAVIOR_DATA_SIZE_CLASSES ||
+        idx >= k_num_max_behavior_data_blocks)
     {
-        assert(false);
-        return nullptr;
+        return false;
     }
 
-    if (version_num != s_behavior_data_block_collection[idx].m_version)
+    auto& block{ s_behavior_data_block_collections[size_class][idx] };
+    if (block.m_reserved.load() != k_reserved)
     {
-        assert(false);
-        return nullptr;
+        return false;
     }
 
-    return &s_behavior_data_block_collection[idx];
+    if (version_num != block.m_version)
+    {
+        return false;
+    }
+
+    out_block = &block;
+    return true;
 }
 
 simulating::Behavior_data_w_version::Behavior_data_w_version()
@@ -132,9 +248,10 @@ void simulating::Behavior_data_w_version::reset(bool reset_all)
 {
     // Reset data.
     std::fill(m_data,
-              m_data + k_behavior_data_block_size,
+              m_data + k_num_behavior_data_buffers * get_size_class_block_size(m_size_class),
               0);
-    
+    m_write_state = 0;
+
     if (reset_all)
     {
         // Reset metadata as well.
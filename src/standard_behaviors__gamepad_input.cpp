@@ -10,7 +10,8 @@ std_behavior::Gamepad_input_behavior::Gamepad_input_behavior()
 {
 }
 
-void std_behavior::Gamepad_input_behavior::set_output(pool::elem_key_t output_humanoid_mvt)
+void std_behavior::Gamepad_input_behavior::set_output(
+    simulating::Behavior_data_key<Humanoid_movement_input_data> output_humanoid_mvt)
 {
     m_output_humanoid_mvt = output_humanoid_mvt;
 }
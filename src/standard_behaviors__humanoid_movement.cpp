@@ -6,17 +6,32 @@
 // class Humanoid_movement.
 std_behavior::Humanoid_movement::Humanoid_movement(
     phys_obj::Actor_character_controller&& phys_char_ctrl)
-    : m_phys_char_ctrl(std::move(phys_char_ctrl))
+    : simulating::Behavior_ifc(
+        simulating::get_size_class<Humanoid_movement_input_data>())
+    , m_phys_char_ctrl(std::move(phys_char_ctrl))
 {
 }
 
 void std_behavior::Humanoid_movement::set_animator(
-    pool::elem_key_t output_animator_ctrl)
+    simulating::Behavior_data_key<Humanoid_animator_input_data> output_animator_ctrl)
 {
     m_output_animator_ctrl = output_animator_ctrl;
 }
 
 void std_behavior::Humanoid_movement::on_update()
+{
+    update();
+}
+
+void std_behavior::Humanoid_movement::update_batch(std::span<Humanoid_movement> behaviors)
+{
+    for (auto& behavior : behaviors)
+    {
+        behavior.update();
+    }
+}
+
+void std_behavior::Humanoid_movement::update()
 {
     auto& input_data{
         get_data_from_input<Humanoid_movement_input_data>() };
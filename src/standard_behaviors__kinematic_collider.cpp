@@ -6,11 +6,26 @@
 // class Kinematic_collider.
 std_behavior::Kinematic_collider::Kinematic_collider(
     phys_obj::Actor_kinematic&& phys_kinematic_actor)
-    : m_phys_kinematic_actor(std::move(phys_kinematic_actor))
+    : simulating::Behavior_ifc(
+        simulating::get_size_class<Kinematic_collider_transform_input_data>())
+    , m_phys_kinematic_actor(std::move(phys_kinematic_actor))
 {
 }
 
 void std_behavior::Kinematic_collider::on_update()
+{
+    update();
+}
+
+void std_behavior::Kinematic_collider::update_batch(std::span<Kinematic_collider> behaviors)
+{
+    for (auto& behavior : behaviors)
+    {
+        behavior.update();
+    }
+}
+
+void std_behavior::Kinematic_collider::update()
 {
     auto& input_data{
         get_data_from_input<Kinematic_collider_transform_input_data>() };
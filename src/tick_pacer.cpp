@@ -0,0 +1,318 @@
+#include "tick_pacer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>  // std::size
+#include <thread>
+
+
+world_sim::Tick_pacer::Tick_pacer(uint32_t tick_hz,
+                                  uint32_t physics_substeps,
+                                  uint32_t max_catch_up_ticks)
+    : m_tick_period(get_tick_period(tick_hz))
+    , m_physics_substeps(physics_substeps)
+    , m_max_catch_up_ticks(max_catch_up_ticks)
+    , m_spin_window(std::chrono::microseconds(1500))
+    , m_next_deadline(clock_t::now())
+    , m_current_deadline(m_next_deadline)
+    , m_current_tick_period(m_tick_period)
+    , m_current_physics_substeps(m_physics_substeps)
+{
+    assert(m_physics_substeps > 0);
+    m_wake_error_samples_us.reserve(k_num_samples);
+    m_tick_interval_samples_us.reserve(k_num_samples);
+}
+
+void world_sim::Tick_pacer::set_tick_hz(uint32_t tick_hz)
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_tick_period = get_tick_period(tick_hz);
+}
+
+void world_sim::Tick_pacer::set_physics_substeps(uint32_t physics_substeps)
+{
+    assert(physics_substeps > 0);
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_physics_substeps = physics_substeps;
+}
+
+void world_sim::Tick_pacer::set_max_catch_up_ticks(uint32_t max_catch_up_ticks)
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_max_catch_up_ticks = max_catch_up_ticks;
+}
+
+float_t world_sim::Tick_pacer::get_tick_delta_time()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return std::chrono::duration<float_t>(m_current_tick_period).count();
+}
+
+uint32_t world_sim::Tick_pacer::get_physics_substeps()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return m_current_physics_substeps;
+}
+
+void world_sim::Tick_pacer::set_wait_mode(Wait_mode wait_mode)
+{
+    assert(wait_mode < NUM_WAIT_MODES);
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_wait_mode = wait_mode;
+    m_is_polling = false;
+}
+
+world_sim::Tick_pacer::Wait_mode world_sim::Tick_pacer::get_wait_mode()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    return m_wait_mode;
+}
+
+void world_sim::Tick_pacer::set_spin_window(std::chrono::nanoseconds spin_window)
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_spin_window = std::chrono::duration_cast<clock_t::duration>(spin_window);
+}
+
+bool world_sim::Tick_pacer::wait_for_next_tick()
+{
+    std::unique_lock<std::mutex> lock{ m_mutex };
+
+    auto wait_begin{ clock_t::now() };
+    auto deadline{ m_next_deadline };
+    auto sleep_end{ wait_begin };
+
+    switch (m_wait_mode)
+    {
+    case WAIT_MODE_POLL:
+        if (wait_begin < deadline)
+        {
+            if (!m_is_polling)
+            {
+                m_is_polling = true;
+                m_first_poll_time = wait_begin;
+            }
+            return false;
+        }
+        if (m_is_polling)
+        {
+            wait_begin = m_first_poll_time;
+            sleep_end = m_first_poll_time;
+            m_is_polling = false;
+        }
+        break;
+
+    case WAIT_MODE_SLEEP_SPIN:
+    {
+        // Don't hold the lock while sleeping or spinning so that the
+        // settings and stats stay accessible.
+        auto spin_begin{ deadline - m_spin_window };
+        lock.unlock();
+        if (wait_begin < spin_begin)
+        {
+            // Park the calling worker until the spin window.
+            std::this_thread::sleep_until(spin_begin);
+            sleep_end = clock_t::now();
+        }
+        while (clock_t::now() < deadline)
+        {
+            std::this_thread::yield();
+        }
+        lock.lock();
+        break;
+    }
+
+    case WAIT_MODE_UNTHROTTLED:
+        deadline = wait_begin;
+        break;
+
+    default:
+        assert(false);
+        break;
+    }
+
+    auto tick_start{ clock_t::now() };
+
+    // Catch up (or drop) the ticks that are owed.
+    uint64_t num_owed_ticks{
+        static_cast<uint64_t>((tick_start - deadline) / m_tick_period) };
+    if (num_owed_ticks > m_max_catch_up_ticks)
+    {
+        m_num_dropped_ticks += num_owed_ticks - m_max_catch_up_ticks;
+        deadline += (num_owed_ticks - m_max_catch_up_ticks) * m_tick_period;
+    }
+    if (num_owed_ticks > 0 && m_wait_mode != WAIT_MODE_UNTHROTTLED)
+    {
+        m_num_catch_up_ticks++;
+    }
+
+    m_current_deadline = deadline;
+    m_current_tick_period = m_tick_period;
+    m_current_physics_substeps = m_physics_substeps;
+    m_next_deadline = deadline + m_tick_period;
+
+    record_tick_start(wait_begin, sleep_end, deadline, tick_start);
+    return true;
+}
+
+void world_sim::Tick_pacer::mark_tick_published()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_published_deadline.store(m_current_deadline.time_since_epoch().count(),
+                               std::memory_order_relaxed);
+    m_published_tick_period.store(m_current_tick_period.count(),
+                                  std::memory_order_relaxed);
+}
+
+float_t world_sim::Tick_pacer::get_interpolation_alpha() const
+{
+    clock_t::rep published_tick_period{
+        m_published_tick_period.load(std::memory_order_relaxed) };
+    if (published_tick_period <= 0)
+    {
+        // Nothing published yet.
+        return 1.0f;
+    }
+
+    clock_t::rep elapsed{
+        clock_t::now().time_since_epoch().count() -
+            m_published_deadline.load(std::memory_order_relaxed) };
+    float_t alpha{ static_cast<float_t>(elapsed) / static_cast<float_t>(published_tick_period) };
+    return std::clamp(alpha, 0.0f, 1.0f);
+}
+
+world_sim::Tick_pacer::Stats world_sim::Tick_pacer::get_stats()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+
+    Stats stats{};
+    stats.num_ticks = m_num_ticks;
+    stats.num_catch_up_ticks = m_num_catch_up_ticks;
+    stats.num_dropped_ticks = m_num_dropped_ticks;
+
+    if (!m_wake_error_samples_us.empty())
+    {
+        std::vector<double> sorted{ m_wake_error_samples_us };
+        std::sort(sorted.begin(), sorted.end());
+
+        double total_us{ 0.0 };
+        for (double sample_us : sorted)
+        {
+            total_us += sample_us;
+        }
+        auto percentile = [&](double p) {
+            size_t idx{ static_cast<size_t>(p * (sorted.size() - 1) + 0.5) };
+            return sorted[idx];
+        };
+
+        stats.wake_error_mean_us = total_us / sorted.size();
+        stats.wake_error_p50_us = percentile(0.50);
+        stats.wake_error_p99_us = percentile(0.99);
+        stats.wake_error_max_us = sorted.back();
+    }
+
+    if (!m_tick_interval_samples_us.empty())
+    {
+        double mean_us{ 0.0 };
+        for (double sample_us : m_tick_interval_samples_us)
+        {
+            mean_us += sample_us;
+        }
+        mean_us /= m_tick_interval_samples_us.size();
+
+        double variance{ 0.0 };
+        for (double sample_us : m_tick_interval_samples_us)
+        {
+            variance += (sample_us - mean_us) * (sample_us - mean_us);
+        }
+        variance /= m_tick_interval_samples_us.size();
+        stats.tick_start_jitter_us = std::sqrt(variance);
+    }
+
+    auto total_wait_time{ m_total_sleep_time + m_total_busy_wait_time };
+    if (total_wait_time.count() > 0)
+    {
+        stats.idle_cpu_busy_fraction =
+            static_cast<double>(m_total_busy_wait_time.count()) / total_wait_time.count();
+    }
+
+    return stats;
+}
+
+void world_sim::Tick_pacer::write_stats(std::ostream& out)
+{
+    static constexpr const char* k_wait_mode_names[]{
+        "POLL",
+        "SLEEP_SPIN",
+        "UNTHROTTLED",
+    };
+    static_assert(std::size(k_wait_mode_names) == NUM_WAIT_MODES);
+
+    auto stats{ get_stats() };
+    out << "wait_mode,num_ticks,wake_error_mean_us,wake_error_p50_us,wake_error_p99_us,"
+           "wake_error_max_us,num_catch_up_ticks,num_dropped_ticks,"
+           "tick_start_jitter_us,idle_cpu_busy_fraction\n"
+        << k_wait_mode_names[get_wait_mode()]
+        << "," << stats.num_ticks
+        << "," << stats.wake_error_mean_us
+        << "," << stats.wake_error_p50_us
+        << "," << stats.wake_error_p99_us
+        << "," << stats.wake_error_max_us
+        << "," << stats.num_catch_up_ticks
+        << "," << stats.num_dropped_ticks
+        << "," << stats.tick_start_jitter_us
+        << "," << stats.idle_cpu_busy_fraction
+        << "\n";
+}
+
+void world_sim::Tick_pacer::reset_stats()
+{
+    std::lock_guard<std::mutex> lock{ m_mutex };
+    m_wake_error_samples_us.clear();
+    m_tick_interval_samples_us.clear();
+    m_num_ticks = 0;
+    m_num_catch_up_ticks = 0;
+    m_num_dropped_ticks = 0;
+    m_total_sleep_time = clock_t::duration{ 0 };
+    m_total_busy_wait_time = clock_t::duration{ 0 };
+}
+
+world_sim::Tick_pacer::clock_t::duration world_sim::Tick_pacer::get_tick_period(uint32_t tick_hz)
+{
+    assert(tick_hz > 0);
+    return std::chrono::duration_cast<clock_t::duration>(
+        std::chrono::nanoseconds(1000000000ull / tick_hz));
+}
+
+void world_sim::Tick_pacer::record_tick_start(clock_t::time_point wait_begin,
+                                              clock_t::time_point sleep_end,
+                                              clock_t::time_point deadline,
+                                              clock_t::time_point tick_start)
+{
+    using us_t = std::chrono::duration<double, std::micro>;
+
+    // Keep the last `k_num_samples` samples.
+    auto record_sample = [&](std::vector<double>& samples, double sample) {
+        if (samples.size() < k_num_samples)
+        {
+            samples.emplace_back(sample);
+        }
+        else
+        {
+            samples[m_num_ticks % k_num_samples] = sample;
+        }
+    };
+
+    record_sample(m_wake_error_samples_us, us_t(tick_start - deadline).count());
+    if (m_num_ticks > 0)
+    {
+        record_sample(m_tick_interval_samples_us, us_t(tick_start - m_prev_tick_start).count());
+    }
+
+    m_total_sleep_time += sleep_end - wait_begin;
+    m_total_busy_wait_time += tick_start - sleep_end;
+
+    m_prev_tick_start = tick_start;
+    m_num_ticks++;
+}
@@ -0,0 +1,263 @@
+#include "tick_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+
+namespace tick_profiler
+{
+
+struct Event
+{
+    uint64_t begin_ns;
+    uint64_t end_ns;
+    uint64_t tick;
+    const char* name;
+    Phase phase;
+};
+
+// Per-thread ring buffer.
+// @NOTE: Only the owning thread writes. Once full, the oldest events get
+//   overwritten.
+struct Thread_ring
+{
+    static constexpr size_t k_capacity{ 16384 };
+    static_assert((k_capacity & (k_capacity - 1)) == 0);
+
+    uint32_t thread_idx;
+    std::atomic_uint64_t num_written{ 0 };
+    Event events[k_capacity];
+};
+
+static std::atomic_bool s_enabled{ false };
+static std::atomic_uint64_t s_current_tick{ 0 };
+
+static std::mutex s_rings_mutex;
+static std::vector<std::unique_ptr<Thread_ring>> s_rings;
+
+static const auto s_epoch{ std::chrono::steady_clock::now() };
+
+static uint64_t now_ns();
+static Thread_ring& get_thread_ring();
+static void gather_events(std::vector<Event>& out_events, std::vector<uint32_t>& out_thread_idxs);
+
+}  // namespace tick_profiler
+
+
+const char* tick_profiler::get_phase_name(Phase phase)
+{
+    switch (phase)
+    {
+        case PHASE_SCHEDULING:              return "SCHEDULING";
+        case PHASE_LOGIC_UPDATE:            return "LOGIC_UPDATE";
+        case PHASE_STEP_PHYSICS:            return "STEP_PHYSICS";
+        case PHASE_UPDATE_TRIGGERS:         return "UPDATE_TRIGGERS";
+        case PHASE_COMBAT:                  return "COMBAT";
+        case PHASE_SCENE_QUERIES:           return "SCENE_QUERIES";
+        case PHASE_DISPATCH_CONTACT_EVENTS: return "DISPATCH_CONTACT_EVENTS";
+        case PHASE_PROPAGATE_TRANSFORMS:    return "PROPAGATE_TRANSFORMS";
+        case PHASE_REMOVE_PENDING_OBJS:     return "REMOVE_PENDING_OBJS";
+        case PHASE_ADD_PENDING_OBJS:        return "ADD_PENDING_OBJS";
+        default:                            assert(false); return "INVALID";
+    }
+}
+
+void tick_profiler::set_enabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool tick_profiler::is_enabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void tick_profiler::set_current_tick(uint64_t tick)
+{
+    s_current_tick.store(tick, std::memory_order_relaxed);
+}
+
+void tick_profiler::clear()
+{
+    std::lock_guard<std::mutex> lock{ s_rings_mutex };
+    for (auto& ring : s_rings)
+    {
+        ring->num_written.store(0, std::memory_order_release);
+    }
+}
+
+// Scoped_event.
+tick_profiler::Scoped_event::Scoped_event(Phase phase, const char* name)
+    : m_phase(phase)
+    , m_name(name)
+    , m_begin_ns(0)
+    , m_recording(is_enabled())
+{
+    if (m_recording)
+    {
+        m_begin_ns = now_ns();
+    }
+}
+
+tick_profiler::Scoped_event::~Scoped_event()
+{
+    if (!m_recording)
+    {
+        return;
+    }
+
+    auto& ring{ get_thread_ring() };
+    uint64_t write_idx{ ring.num_written.load(std::memory_order_relaxed) };
+    ring.events[write_idx & (Thread_ring::k_capacity - 1)] = {
+        .begin_ns{ m_begin_ns },
+        .end_ns{ now_ns() },
+        .tick{ s_current_tick.load(std::memory_order_relaxed) },
+        .name{ m_name },
+        .phase{ m_phase },
+    };
+    ring.num_written.store(write_idx + 1, std::memory_order_release);
+}
+
+// Export.
+void tick_profiler::write_chrome_trace_json(std::ostream& out)
+{
+    std::vector<Event> events;
+    std::vector<uint32_t> thread_idxs;
+    gather_events(events, thread_idxs);
+
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        auto& event{ events[i] };
+        out << (i == 0 ? "" : ",")
+            << "\n{\"name\":\"" << event.name
+            << "\",\"cat\":\"" << get_phase_name(event.phase)
+            << "\",\"ph\":\"X\""
+            << ",\"ts\":" << (event.begin_ns / 1000.0)
+            << ",\"dur\":" << ((event.end_ns - event.begin_ns) / 1000.0)
+            << ",\"pid\":0"
+            << ",\"tid\":" << thread_idxs[i]
+            << ",\"args\":{\"tick\":" << event.tick << "}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+void tick_profiler::compute_phase_stats(Phase_stats out_stats[NUM_PHASES])
+{
+    std::vector<Event> events;
+    std::vector<uint32_t> thread_idxs;
+    gather_events(events, thread_idxs);
+
+    // Span of each phase per tick.
+    struct Span
+    {
+        uint64_t begin_ns{ (uint64_t)-1 };
+        uint64_t end_ns{ 0 };
+    };
+    std::unordered_map<uint64_t, Span> spans_per_tick[NUM_PHASES];
+    for (auto& event : events)
+    {
+        auto& span{ spans_per_tick[event.phase][event.tick] };
+        span.begin_ns = std::min(span.begin_ns, event.begin_ns);
+        span.end_ns = std::max(span.end_ns, event.end_ns);
+    }
+
+    for (uint32_t phase = 0; phase < NUM_PHASES; phase++)
+    {
+        std::vector<double> durations_us;
+        durations_us.reserve(spans_per_tick[phase].size());
+        for (auto& [tick, span] : spans_per_tick[phase])
+        {
+            durations_us.emplace_back((span.end_ns - span.begin_ns) / 1000.0);
+        }
+        std::sort(durations_us.begin(), durations_us.end());
+
+        auto& stats{ out_stats[phase] };
+        stats = {};
+        stats.num_ticks = durations_us.size();
+        if (durations_us.empty())
+        {
+            continue;
+        }
+
+        double total_us{ 0.0 };
+        for (double duration_us : durations_us)
+        {
+            total_us += duration_us;
+        }
+        auto percentile = [&](double p) {
+            size_t idx{ static_cast<size_t>(p * (durations_us.size() - 1) + 0.5) };
+            return durations_us[idx];
+        };
+
+        stats.mean_us = total_us / durations_us.size();
+        stats.p50_us = percentile(0.50);
+        stats.p99_us = percentile(0.99);
+        stats.max_us = durations_us.back();
+    }
+}
+
+void tick_profiler::write_phase_stats(std::ostream& out)
+{
+    Phase_stats stats[NUM_PHASES];
+    compute_phase_stats(stats);
+
+    out << "phase,num_ticks,mean_us,p50_us,p99_us,max_us\n";
+    for (uint32_t phase = 0; phase < NUM_PHASES; phase++)
+    {
+        out << get_phase_name(static_cast<Phase>(phase))
+            << "," << stats[phase].num_ticks
+            << "," << stats[phase].mean_us
+            << "," << stats[phase].p50_us
+            << "," << stats[phase].p99_us
+            << "," << stats[phase].max_us
+            << "\n";
+    }
+}
+
+// Helpers.
+uint64_t tick_profiler::now_ns()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - s_epoch).count());
+}
+
+tick_profiler::Thread_ring& tick_profiler::get_thread_ring()
+{
+    thread_local Thread_ring* t_ring{ nullptr };
+    if (t_ring == nullptr)
+    {
+        // Register new ring for this thread.
+        std::lock_guard<std::mutex> lock{ s_rings_mutex };
+        s_rings.emplace_back(std::make_unique<Thread_ring>());
+        t_ring = s_rings.back().get();
+        t_ring->thread_idx = static_cast<uint32_t>(s_rings.size() - 1);
+    }
+    return *t_ring;
+}
+
+void tick_profiler::gather_events(std::vector<Event>& out_events,
+                                  std::vector<uint32_t>& out_thread_idxs)
+{
+    std::lock_guard<std::mutex> lock{ s_rings_mutex };
+    for (auto& ring : s_rings)
+    {
+        uint64_t num_written{ ring->num_written.load(std::memory_order_acquire) };
+        uint64_t first{
+            num_written > Thread_ring::k_capacity ?
+                num_written - Thread_ring::k_capacity :
+                0 };
+        for (uint64_t i = first; i < num_written; i++)
+        {
+            out_events.emplace_back(ring->events[i & (Thread_ring::k_capacity - 1)]);
+            out_thread_idxs.emplace_back(ring->thread_idx);
+        }
+    }
+}
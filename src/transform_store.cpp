@@ -0,0 +1,383 @@
+#include "transform_store.h"
+
+#include <algorithm>
+#include <bit>  // std::countr_zero
+#include <cassert>
+#include <mutex>
+#include "cglm/cglm.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAWSOO_TRANSFORM_STORE_USE_SSE 1
+#include <xmmintrin.h>
+#else
+#define HAWSOO_TRANSFORM_STORE_USE_SSE 0
+#endif
+
+
+namespace world_sim
+{
+
+static constexpr size_t k_read_a_offset{ 0 };
+static constexpr size_t k_read_b_offset{ 1 };
+static constexpr size_t k_write_offset{ 2 };
+static constexpr size_t k_num_buffers{ 3 };
+
+enum Transform_component : uint32_t
+{
+    POS_X = 0, POS_Y, POS_Z,
+    ROT_X, ROT_Y, ROT_Z, ROT_W,
+    SCA_X, SCA_Y, SCA_Z,
+    NUM_TRANSFORM_COMPONENTS
+};
+
+alignas(64) static float_t s_components
+    [k_num_buffers][NUM_TRANSFORM_COMPONENTS][Transform_store::k_max_transforms];
+alignas(64) static float_t s_interpolate_masks[Transform_store::k_max_transforms];  // 1.0 to interpolate, 0.0 to read latest.
+
+// Live slots of each buffer (ascending), published along with the buffer.
+static uint32_t s_published_slots[k_num_buffers][Transform_store::k_max_transforms];
+static size_t s_num_published_slots[k_num_buffers]{};
+static uint64_t s_published_slots_versions[k_num_buffers]{};
+
+// Slot bookkeeping.
+static std::mutex s_slots_mutex;
+static uint64_t s_live_slot_bits[Transform_store::k_max_transforms / 64]{};
+static uint64_t s_live_slots_version{ 0 };
+static uint32_t s_num_used_slots{ 0 };  // High water mark.
+static uint32_t s_free_slots[Transform_store::k_max_transforms];
+static size_t s_num_free_slots{ 0 };
+
+// Destroyed slots (FIFO) waiting until no published table holds them.
+static uint32_t s_retired_slots[Transform_store::k_max_transforms];
+static size_t s_retired_slots_begin{ 0 };
+static size_t s_num_retired_slots{ 0 };
+static size_t s_slot_retire_offsets[Transform_store::k_max_transforms];
+
+static void compose_transform_scalar(size_t buffer_offset,
+                                     uint32_t slot,
+                                     float_t t,
+                                     mat4& out_transform);
+
+}  // namespace world_sim
+
+
+uint32_t world_sim::Transform_store::allocate_one(bool interpolate,
+                                                  const float_t position[3],
+                                                  const versor rotation,
+                                                  const vec3 scale)
+{
+    std::lock_guard<std::mutex> lock{ s_slots_mutex };
+
+    uint32_t slot;
+    if (s_num_free_slots > 0)
+    {
+        slot = s_free_slots[--s_num_free_slots];
+    }
+    else if (s_num_used_slots < k_max_transforms)
+    {
+        slot = s_num_used_slots++;
+    }
+    else
+    {
+        // Out of transforms.
+        assert(false);
+        return k_invalid_idx;
+    }
+
+    // @NOTE: No published table holds this slot, so the readers aren't
+    //   touching any of its buffers.
+    for (size_t buffer = 0; buffer < k_num_buffers; buffer++)
+    {
+        auto& components{ s_components[buffer] };
+        components[POS_X][slot] = position[0];
+        components[POS_Y][slot] = position[1];
+        components[POS_Z][slot] = position[2];
+        components[ROT_X][slot] = rotation[0];
+        components[ROT_Y][slot] = rotation[1];
+        components[ROT_Z][slot] = rotation[2];
+        components[ROT_W][slot] = rotation[3];
+        components[SCA_X][slot] = scale[0];
+        components[SCA_Y][slot] = scale[1];
+        components[SCA_Z][slot] = scale[2];
+    }
+    s_interpolate_masks[slot] = (interpolate ? 1.0f : 0.0f);
+
+    s_live_slot_bits[slot / 64] |= (uint64_t(1) << (slot % 64));
+    s_live_slots_version++;
+    return slot;
+}
+
+void world_sim::Transform_store::destroy_one(uint32_t slot)
+{
+    std::lock_guard<std::mutex> lock{ s_slots_mutex };
+
+    uint64_t slot_bit{ uint64_t(1) << (slot % 64) };
+    if (slot >= s_num_used_slots || (s_live_slot_bits[slot / 64] & slot_bit) == 0)
+    {
+        assert(false);
+        return;
+    }
+
+    s_live_slot_bits[slot / 64] &= ~slot_bit;
+    s_live_slots_version++;
+
+    // Published tables can still hold the slot, so don't reuse it yet.
+    s_retired_slots[(s_retired_slots_begin + s_num_retired_slots) % k_max_transforms] = slot;
+    s_num_retired_slots++;
+    s_slot_retire_offsets[slot] = s_buffer_offset;
+}
+
+void world_sim::Transform_store::set_interpolate(uint32_t slot, bool interpolate)
+{
+    assert(slot < k_max_transforms);
+    s_interpolate_masks[slot] = (interpolate ? 1.0f : 0.0f);
+}
+
+void world_sim::Transform_store::write_transform(uint32_t slot,
+                                                 const float_t position[3],
+                                                 const versor rotation,
+                                                 const vec3 scale)
+{
+    assert(slot < k_max_transforms);
+    auto& components{ s_components[(s_buffer_offset + k_write_offset) % k_num_buffers] };
+    components[POS_X][slot] = position[0];
+    components[POS_Y][slot] = position[1];
+    components[POS_Z][slot] = position[2];
+    components[ROT_X][slot] = rotation[0];
+    components[ROT_Y][slot] = rotation[1];
+    components[ROT_Z][slot] = rotation[2];
+    components[ROT_W][slot] = rotation[3];
+    components[SCA_X][slot] = scale[0];
+    components[SCA_Y][slot] = scale[1];
+    components[SCA_Z][slot] = scale[2];
+}
+
+void world_sim::Transform_store::increment_buffer_offset()
+{
+    std::lock_guard<std::mutex> lock{ s_slots_mutex };
+
+    // Publish the live slots along with the write buffer.
+    size_t buffer_offset{ s_buffer_offset };
+    size_t write_buffer{ (buffer_offset + k_write_offset) % k_num_buffers };
+    if (s_published_slots_versions[write_buffer] != s_live_slots_version)
+    {
+        auto& slots{ s_published_slots[write_buffer] };
+        size_t num_slots{ 0 };
+        for (uint32_t word = 0; word < (s_num_used_slots + 63) / 64; word++)
+        {
+            for (uint64_t bits = s_live_slot_bits[word]; bits != 0; bits &= bits - 1)
+            {
+                slots[num_slots++] = word * 64 + static_cast<uint32_t>(std::countr_zero(bits));
+            }
+        }
+        s_num_published_slots[write_buffer] = num_slots;
+        s_published_slots_versions[write_buffer] = s_live_slots_version;
+    }
+
+    s_buffer_offset = ++buffer_offset;
+
+    // Recycle the retired slots that no published table holds anymore.
+    while (s_num_retired_slots > 0)
+    {
+        uint32_t slot{ s_retired_slots[s_retired_slots_begin] };
+        if (buffer_offset - s_slot_retire_offsets[slot] < k_num_buffers)
+        {
+            break;
+        }
+        s_free_slots[s_num_free_slots++] = slot;
+        s_retired_slots_begin = (s_retired_slots_begin + 1) % k_max_transforms;
+        s_num_retired_slots--;
+    }
+}
+
+void world_sim::Transform_store::read_transform(uint32_t slot, float_t t, mat4& out_transform)
+{
+    // @TODO: In the future with world chunks and camera tricks for rendering large worlds,
+    //   convert the true transforms into the camera based transform here!
+    //   For now tho, it all just gets truncated.
+    assert(slot < k_max_transforms);
+    compose_transform_scalar(s_buffer_offset, slot, t, out_transform);
+}
+
+size_t world_sim::Transform_store::read_all_transforms(float_t t,
+                                                       mat4* out_transforms,
+                                                       size_t count,
+                                                       uint32_t* out_slots)
+{
+    size_t buffer_offset_copy{ s_buffer_offset };  // To only do one atomic load.
+    const uint32_t* slots{
+        s_published_slots[(buffer_offset_copy + k_read_b_offset) % k_num_buffers] };
+    count = std::min(count,
+                     s_num_published_slots[(buffer_offset_copy + k_read_b_offset) % k_num_buffers]);
+    if (out_slots != nullptr)
+    {
+        std::copy(slots, slots + count, out_slots);
+    }
+
+    size_t idx{ 0 };
+
+#if HAWSOO_TRANSFORM_STORE_USE_SSE
+    auto& a{ s_components[(buffer_offset_copy + k_read_a_offset) % k_num_buffers] };
+    auto& b{ s_components[(buffer_offset_copy + k_read_b_offset) % k_num_buffers] };
+
+    const __m128 zero{ _mm_setzero_ps() };
+    const __m128 one{ _mm_set1_ps(1.0f) };
+    const __m128 two{ _mm_set1_ps(2.0f) };
+    const __m128 sign_bit{ _mm_set1_ps(-0.0f) };
+    const __m128 t_minus_one{ _mm_set1_ps(t - 1.0f) };
+
+    // 4 transforms per iteration.
+    for (; idx + 4 <= count; idx += 4)
+    {
+        // Slots are ascending and unique, so this means they're consecutive
+        // (the usual case unless transforms got destroyed).
+        const uint32_t* block_slots{ slots + idx };
+        bool is_contiguous{ block_slots[3] - block_slots[0] == 3 };
+        auto load = [&](const float_t* values) {
+            return (is_contiguous ?
+                        _mm_loadu_ps(&values[block_slots[0]]) :
+                        _mm_setr_ps(values[block_slots[0]],
+                                    values[block_slots[1]],
+                                    values[block_slots[2]],
+                                    values[block_slots[3]]));
+        };
+
+    // Non-interpolated transforms read the latest buffer (t = 1).
+        __m128 tt{ _mm_add_ps(one, _mm_mul_ps(load(s_interpolate_masks), t_minus_one)) };
+
+        auto lerp = [&](uint32_t component) {
+            __m128 va{ load(a[component]) };
+            __m128 vb{ load(b[component]) };
+            return _mm_add_ps(va, _mm_mul_ps(tt, _mm_sub_ps(vb, va)));
+        };
+
+        __m128 px{ lerp(POS_X) };
+        __m128 py{ lerp(POS_Y) };
+        __m128 pz{ lerp(POS_Z) };
+        __m128 sx{ lerp(SCA_X) };
+        __m128 sy{ lerp(SCA_Y) };
+        __m128 sz{ lerp(SCA_Z) };
+
+        // Quaternion nlerp (shortest path, same as `glm_quat_nlerp`).
+        __m128 ax{ load(a[ROT_X]) };
+        __m128 ay{ load(a[ROT_Y]) };
+        __m128 az{ load(a[ROT_Z]) };
+        __m128 aw{ load(a[ROT_W]) };
+        __m128 bx{ load(b[ROT_X]) };
+        __m128 by{ load(b[ROT_Y]) };
+        __m128 bz{ load(b[ROT_Z]) };
+        __m128 bw{ load(b[ROT_W]) };
+
+        __m128 dot{
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)),
+                       _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw))) };
+        __m128 flip{ _mm_and_ps(dot, sign_bit) };
+        bx = _mm_xor_ps(bx, flip);
+        by = _mm_xor_ps(by, flip);
+        bz = _mm_xor_ps(bz, flip);
+        bw = _mm_xor_ps(bw, flip);
+
+        __m128 qx{ _mm_add_ps(ax, _mm_mul_ps(tt, _mm_sub_ps(bx, ax))) };
+        __m128 qy{ _mm_add_ps(ay, _mm_mul_ps(tt, _mm_sub_ps(by, ay))) };
+        __m128 qz{ _mm_add_ps(az, _mm_mul_ps(tt, _mm_sub_ps(bz, az))) };
+        __m128 qw{ _mm_add_ps(aw, _mm_mul_ps(tt, _mm_sub_ps(bw, aw))) };
+
+        __m128 len2{
+            _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)),
+                       _mm_add_ps(_mm_mul_ps(qz, qz), _mm_mul_ps(qw, qw))) };
+        __m128 inv_len{ _mm_div_ps(one, _mm_sqrt_ps(len2)) };
+        qx = _mm_mul_ps(qx, inv_len);
+        qy = _mm_mul_ps(qy, inv_len);
+        qz = _mm_mul_ps(qz, inv_len);
+        qw = _mm_mul_ps(qw, inv_len);
+
+        // Rotation matrix (same as `glm_quat_mat4`).
+        __m128 xx{ _mm_mul_ps(qx, qx) };
+        __m128 yy{ _mm_mul_ps(qy, qy) };
+        __m128 zz{ _mm_mul_ps(qz, qz) };
+        __m128 xy{ _mm_mul_ps(qx, qy) };
+        __m128 xz{ _mm_mul_ps(qx, qz) };
+        __m128 yz{ _mm_mul_ps(qy, qz) };
+        __m128 wx{ _mm_mul_ps(qw, qx) };
+        __m128 wy{ _mm_mul_ps(qw, qy) };
+        __m128 wz{ _mm_mul_ps(qw, qz) };
+
+        // Columns scaled (translate * rotate * scale).
+        __m128 c0x{ _mm_mul_ps(sx, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz)))) };
+        __m128 c0y{ _mm_mul_ps(sx, _mm_mul_ps(two, _mm_add_ps(xy, wz))) };
+        __m128 c0z{ _mm_mul_ps(sx, _mm_mul_ps(two, _mm_sub_ps(xz, wy))) };
+        __m128 c0w{ zero };
+
+        __m128 c1x{ _mm_mul_ps(sy, _mm_mul_ps(two, _mm_sub_ps(xy, wz))) };
+        __m128 c1y{ _mm_mul_ps(sy, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz)))) };
+        __m128 c1z{ _mm_mul_ps(sy, _mm_mul_ps(two, _mm_add_ps(yz, wx))) };
+        __m128 c1w{ zero };
+
+        __m128 c2x{ _mm_mul_ps(sz, _mm_mul_ps(two, _mm_add_ps(xz, wy))) };
+        __m128 c2y{ _mm_mul_ps(sz, _mm_mul_ps(two, _mm_sub_ps(yz, wx))) };
+        __m128 c2z{ _mm_mul_ps(sz, _mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy)))) };
+        __m128 c2w{ zero };
+
+        __m128 c3w{ one };
+
+        // Transpose from SoA lanes into one column per transform.
+        _MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+        _MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+        _MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+        _MM_TRANSPOSE4_PS(px, py, pz, c3w);
+
+        mat4* out{ out_transforms + idx };
+        _mm_storeu_ps(out[0][0], c0x); _mm_storeu_ps(out[0][1], c1x); _mm_storeu_ps(out[0][2], c2x); _mm_storeu_ps(out[0][3], px);
+        _mm_storeu_ps(out[1][0], c0y); _mm_storeu_ps(out[1][1], c1y); _mm_storeu_ps(out[1][2], c2y); _mm_storeu_ps(out[1][3], py);
+        _mm_storeu_ps(out[2][0], c0z); _mm_storeu_ps(out[2][1], c1z); _mm_storeu_ps(out[2][2], c2z); _mm_storeu_ps(out[2][3], pz);
+        _mm_storeu_ps(out[3][0], c0w); _mm_storeu_ps(out[3][1], c1w); _mm_storeu_ps(out[3][2], c2w); _mm_storeu_ps(out[3][3], c3w);
+    }
+#endif  // HAWSOO_TRANSFORM_STORE_USE_SSE
+
+    // Remainder.
+    for (; idx < count; idx++)
+    {
+        compose_transform_scalar(buffer_offset_copy, slots[idx], t, out_transforms[idx]);
+    }
+
+    return count;
+}
+
+size_t world_sim::Transform_store::get_num_transforms()
+{
+    return s_num_published_slots[(s_buffer_offset + k_read_b_offset) % k_num_buffers];
+}
+
+// Helpers.
+void world_sim::compose_transform_scalar(size_t buffer_offset,
+                                         uint32_t slot,
+                                         float_t t,
+                                         mat4& out_transform)
+{
+    auto& a{ s_components[(buffer_offset + k_read_a_offset) % k_num_buffers] };
+    auto& b{ s_components[(buffer_offset + k_read_b_offset) % k_num_buffers] };
+
+    // Non-interpolated transforms read the latest buffer (t = 1).
+    float_t tt{ 1.0f + s_interpolate_masks[slot] * (t - 1.0f) };
+
+    vec3   pos;
+    versor rot_a{ a[ROT_X][slot], a[ROT_Y][slot], a[ROT_Z][slot], a[ROT_W][slot] };
+    versor rot_b{ b[ROT_X][slot], b[ROT_Y][slot], b[ROT_Z][slot], b[ROT_W][slot] };
+    versor rot;
+    vec3   sca;
+
+    pos[0] = a[POS_X][slot] + tt * (b[POS_X][slot] - a[POS_X][slot]);
+    pos[1] = a[POS_Y][slot] + tt * (b[POS_Y][slot] - a[POS_Y][slot]);
+    pos[2] = a[POS_Z][slot] + tt * (b[POS_Z][slot] - a[POS_Z][slot]);
+
+    glm_quat_nlerp(rot_a, rot_b, tt, rot);
+
+    sca[0] = a[SCA_X][slot] + tt * (b[SCA_X][slot] - a[SCA_X][slot]);
+    sca[1] = a[SCA_Y][slot] + tt * (b[SCA_Y][slot] - a[SCA_Y][slot]);
+    sca[2] = a[SCA_Z][slot] + tt * (b[SCA_Z][slot] - a[SCA_Z][slot]);
+
+    // Write transform.
+    glm_translate_make(out_transform, pos);
+    glm_quat_rotate(out_transform, rot, out_transform);
+    glm_scale(out_transform, sca);
+}
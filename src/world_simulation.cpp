@@ -1,12 +1,51 @@
 #include "world_simulation.h"
 
+#include <algorithm>  // std::min
 #include <cassert>
 #include <chrono>
 #include <iostream>
+#include <iterator>  // std::size
+#include "alloc_counter.h"
+#include "physics_objects.h"
 #include "simulating_ifc.h"
+#include "tick_profiler.h"
 #include "world_simulation_settings.h"
 
 
+// Job pools.
+template<typename Job_t>
+void World_simulation::create_jobs(std::vector<std::unique_ptr<Job_t>>& jobs, size_t num_jobs)
+{
+    jobs.reserve(num_jobs);
+    while (jobs.size() < num_jobs)
+    {
+        jobs.emplace_back(std::make_unique<Job_t>(*this));
+    }
+}
+
+template<typename Job_t>
+void World_simulation::emit_range_jobs(std::vector<std::unique_ptr<Job_t>>& jobs,
+                                       size_t count,
+                                       size_t batch_size,
+                                       std::vector<Job_ifc*>& out_jobs)
+{
+    // Batches of `batch_size`, or bigger ones if the pool runs out.
+    size_t num_jobs{ std::min((count + batch_size - 1) / batch_size, jobs.size()) };
+    for (size_t i = 0; i < num_jobs; i++)
+    {
+        jobs[i]->set_range(count * i / num_jobs, count * (i + 1) / num_jobs);
+        out_jobs.emplace_back(jobs[i].get());
+    }
+}
+
+void World_simulation::reserve_next_jobs()
+{
+    // Largest states: the logic update (J2 and J7) and the physics queries.
+    m_next_jobs.reserve(
+        std::max(m_j2_execute_simulation_tick_jobs.size() + m_j7_execute_behavior_batch_jobs.size(),
+                 k_max_range_stages_per_state * m_max_range_jobs));
+}
+
 World_simulation::World_simulation(std::atomic_size_t& num_job_sources_setup_incomplete,
                                    uint32_t num_threads)
     : m_num_job_sources_setup_incomplete(num_job_sources_setup_incomplete)
@@ -16,133 +55,370 @@ World_simulation::World_simulation(std::atomic_size_t& num_job_sources_setup_inc
         std::make_unique<J3_remove_pending_objs_job>(*this))
     , m_j4_add_pending_objs_job(
         std::make_unique<J4_add_pending_objs_job>(*this))
+    , m_j5_step_physics_world_job(
+        std::make_unique<J5_step_physics_world_job>(*this))
+    , m_j11_report_combat_hits_job(
+        std::make_unique<J11_report_combat_hits_job>(*this))
+    , m_j13_collect_contact_events_job(
+        std::make_unique<J13_collect_contact_events_job>(*this))
+    , m_j14_find_combat_candidates_job(
+        std::make_unique<J14_find_combat_candidates_job>(*this))
     , m_current_state(Job_source_state::SETUP_PHYSICS_WORLD)
-    , m_timekeeper(k_world_sim_hz, true)
+    , m_tick_pacer(k_world_sim_hz,
+                   k_world_sim_physics_substeps,
+                   k_world_sim_max_catch_up_ticks)
+    , m_num_threads(num_threads)
 {
     // Init behavior data pool.
     simulating::Behavior_data_w_version::initialize_data_pool();
 
     // Init entity pool.
     std::lock_guard<std::mutex> lock{ m_entity_pool_mutex };
-    m_entity_pool.reserve(k_num_max_entities);
-    for (size_t i = 0; i < k_num_max_entities; i++)
+    m_entity_pool.resize(k_num_max_entities);
+    for (uint32_t i = 0; i < k_num_max_entities; i++)
     {
-        m_entity_pool.emplace_back(nullptr);
+        m_entity_pool[i].next_free_idx =
+            (i + 1 < k_num_max_entities ? i + 1 : k_no_free_entity_idx);
     }
+    m_entity_pool_free_head = 0;
+
+    // Create the job pools of the parallel stages.
+    m_max_range_jobs = std::max<size_t>(1, m_num_threads) * k_range_jobs_per_thread;
+    create_jobs(m_j2_execute_simulation_tick_jobs,
+                std::max<size_t>(1, m_num_threads) * k_behavior_jobs_per_thread);
+    create_jobs(m_j6_propagate_transforms_jobs, m_max_range_jobs);
+    create_jobs(m_j7_execute_behavior_batch_jobs, m_max_range_jobs);
+    create_jobs(m_j8_dispatch_contact_events_jobs, m_max_range_jobs);
+    create_jobs(m_j9_update_triggers_jobs, m_max_range_jobs);
+    create_jobs(m_j10_query_hurtboxes_jobs, m_max_range_jobs);
+    create_jobs(m_j12_run_scene_queries_jobs, m_max_range_jobs);
+    reserve_next_jobs();
 }
 
 void World_simulation::add_sim_entity_to_world(std::unique_ptr<simulating::Entity_ifc>&& entity)
 {
-    std::lock_guard<std::mutex> lock{ m_insertion_queue_mutex };
-    m_insertion_queue.emplace_back(std::move(entity));
+    m_insertion_queue.push(std::move(entity));
 }
 
-void World_simulation::remove_entity_from_world(size_t entity_idx)
+void World_simulation::remove_entity_from_world(entity_key_t entity_key)
 {
-    std::lock_guard<std::mutex> lock{ m_deletion_indices_queue_mutex };
-    m_deletion_indices_queue.emplace_back(entity_idx);
+    m_deletion_keys_queue.push(std::move(entity_key));
 }
 
 simulating::Edit_behavior_groups_ifc::behavior_group_key_t
     World_simulation::add_behavior_group(Behavior_group&& group)
 {
-    std::lock_guard<std::mutex> lock{ m_behavior_pool_mutex };
-    behavior_group_key_t key{ m_behavior_pool_key_generator++ };
-    m_behavior_pool.emplace(key, std::move(group));
+    behavior_group_key_t key;
+    {
+        std::lock_guard<std::mutex> lock{ m_behavior_group_slots_mutex };
+
+        // Reserve slot.
+        uint32_t idx{ m_behavior_group_free_head };
+        if (idx == k_no_behavior_group_idx)
+        {
+            idx = static_cast<uint32_t>(m_behavior_group_slots.size());
+            m_behavior_group_slots.emplace_back();
+        }
+        else
+        {
+            m_behavior_group_free_head = m_behavior_group_slots[idx].next_free_idx;
+        }
+
+        auto& slot{ m_behavior_group_slots[idx] };
+        slot.version++;
+        slot.dense_idx = k_no_behavior_group_idx;
+        slot.next_free_idx = k_no_behavior_group_idx;
+        slot.in_use = true;
+        key = pool::create_elem_key(idx, slot.version);
+    }
+
+    m_pending_behavior_group_adds.push({ key, std::move(group) });
     return key;
 }
 
 void World_simulation::remove_behavior_group(behavior_group_key_t group_key)
 {
-    std::lock_guard<std::mutex> lock{ m_behavior_pool_mutex };
-
-    if (m_behavior_pool.find(group_key) != m_behavior_pool.end())
     {
-        m_behavior_pool.erase(group_key);
+        std::lock_guard<std::mutex> lock{ m_behavior_group_slots_mutex };
+
+        uint32_t idx, version_num;
+        pool::elem_key_extract_data(group_key, idx, version_num);
+        if (idx >= m_behavior_group_slots.size() ||
+            !m_behavior_group_slots[idx].in_use ||
+            m_behavior_group_slots[idx].version != version_num)
+        {
+            // Key not found.
+            assert(false);
+            return;
+        }
     }
-    else
+
+    m_pending_behavior_group_removes.push(std::move(group_key));
+}
+
+bool World_simulation::apply_pending_behavior_group_edits()
+{
+    std::lock_guard<std::mutex> lock{ m_behavior_group_slots_mutex };
+
+    // @NOTE: Adds go first so that a group added and removed within the same
+    //   tick gets removed.
+    size_t num_edits{ 0 };
+    num_edits += m_pending_behavior_group_adds.drain(
+        [&](std::pair<behavior_group_key_t, Behavior_group>&& pending_add) {
+            uint32_t idx, version_num;
+            pool::elem_key_extract_data(pending_add.first, idx, version_num);
+
+            auto& slot{ m_behavior_group_slots[idx] };
+            assert(slot.in_use && slot.version == version_num);
+            slot.dense_idx = static_cast<uint32_t>(m_behavior_groups.size());
+            m_behavior_groups.emplace_back(std::move(pending_add.second));
+            m_behavior_group_slot_idxs.emplace_back(idx);
+        });
+
+    num_edits += m_pending_behavior_group_removes.drain([&](behavior_group_key_t&& key) {
+        uint32_t idx, version_num;
+        pool::elem_key_extract_data(key, idx, version_num);
+
+        auto& slot{ m_behavior_group_slots[idx] };
+        if (!slot.in_use || slot.version != version_num)
+        {
+            // Stale key (group already removed).
+            return;
+        }
+
+        // Swap-remove.
+        uint32_t dense_idx{ slot.dense_idx };
+        uint32_t last_idx{ static_cast<uint32_t>(m_behavior_groups.size() - 1) };
+        if (dense_idx != last_idx)
+        {
+            m_behavior_groups[dense_idx] = std::move(m_behavior_groups[last_idx]);
+            m_behavior_group_slot_idxs[dense_idx] = m_behavior_group_slot_idxs[last_idx];
+            m_behavior_group_slots[m_behavior_group_slot_idxs[dense_idx]].dense_idx = dense_idx;
+        }
+        m_behavior_groups.pop_back();
+        m_behavior_group_slot_idxs.pop_back();
+
+        // Return slot to free list.
+        slot.in_use = false;
+        slot.dense_idx = k_no_behavior_group_idx;
+        slot.next_free_idx = m_behavior_group_free_head;
+        m_behavior_group_free_head = idx;
+    });
+
+    return (num_edits > 0);
+}
+
+void World_simulation::remove_batched_behavior(simulating::Batched_behavior_key key)
+{
+    std::lock_guard<std::mutex> lock{ m_behavior_batches_mutex };
+
+    if (key.type_idx >= m_behavior_batches.size() ||
+        m_behavior_batches[key.type_idx] == nullptr ||
+        !m_behavior_batches[key.type_idx]->remove(key.elem_key))
     {
         // Key not found.
         assert(false);
     }
 }
 
-// Jobs.
-int32_t World_simulation::J2_execute_simulation_tick_job::execute()
+simulating::Behavior_batch_ifc& World_simulation::get_behavior_batch(uint32_t type_idx,
+                                                                     create_behavior_batch_fn_t create_fn)
 {
-    // Execute all behavior groups.
-    for (auto& behavior : *m_group_ptr)
+    std::lock_guard<std::mutex> lock{ m_behavior_batches_mutex };
+
+    if (type_idx >= m_behavior_batches.size())
     {
-        behavior->on_update();
+        m_behavior_batches.resize(type_idx + 1);
     }
 
-    // Tick physics system.
-    // @TODO: @NOCHECKIN: For some reason with this lock, the update function works? Is this an issue with the thread system's work??? Idk.
-    //static std::mutex s_force_visibility_mutex;
-    //std::lock_guard<std::mutex> lock{ s_force_visibility_mutex };
+    auto& batch{ m_behavior_batches[type_idx] };
+    if (batch == nullptr)
+    {
+        batch = create_fn();
 
-    // @NOTE: @FAILED: Tried doing a simple wait to see if that would be enough
-    //   time for visibility to propagate, however, it needs to be the lock or
-    //   else it does not work.  -Thea 2025/04/19
-#if 0
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-#endif  // 0
+        // One more J7 job for the partial chunk of the new type.
+        create_jobs(m_j7_execute_behavior_batch_jobs, m_j7_execute_behavior_batch_jobs.size() + 1);
+        reserve_next_jobs();
+    }
+    return *batch;
+}
 
-    m_world_sim.update_physics_system();
+// Jobs.
+int32_t World_simulation::J2_execute_simulation_tick_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_LOGIC_UPDATE, "J2 execute behaviors");
+
+    // Execute chunk of the behavior schedule.
+    auto& nodes{ m_world_sim.m_behavior_schedule_nodes };
+    if (!m_measure_costs)
+    {
+        for (size_t i = m_begin; i < m_end; i++)
+        {
+            nodes[i]->on_update();
+        }
+        return 0;
+    }
 
-    // Propagate new simulated positions to transform holders.
-    assert(false);  // @TODO.
+    // Sample tick. Time each behavior.
+    auto& costs{ m_world_sim.m_behavior_schedule_costs };
+    for (size_t i = m_begin; i < m_end; i++)
+    {
+        auto start{ std::chrono::steady_clock::now() };
+        nodes[i]->on_update();
+        float_t sample_ns{
+            std::chrono::duration<float_t, std::nano>(std::chrono::steady_clock::now() - start).count() };
+
+        costs[i] = (costs[i] < 0.0f ?
+                        sample_ns :
+                        costs[i] + k_behavior_cost_ema_alpha * (sample_ns - costs[i]));
+    }
 
     return 0;
 }
 
-int32_t World_simulation::J3_remove_pending_objs_job::execute()
+int32_t World_simulation::J7_execute_behavior_batch_job::execute()
 {
-    std::lock_guard<std::mutex> lock1{ m_world_sim.m_deletion_indices_queue_mutex };
-    std::lock_guard<std::mutex> lock2{ m_world_sim.m_entity_pool_mutex };
-    for (auto idx : m_world_sim.m_deletion_indices_queue)
-    {
-        auto& entity{ m_world_sim.m_entity_pool[idx] };
-        entity->on_teardown(m_world_sim);
-        entity = nullptr;
-    }
-    // if (!m_world_sim.m_deletion_indices_queue.empty())
-    //     m_world_sim.m_rebuild_entity_list = true;
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_LOGIC_UPDATE, "J7 execute behavior batch");
 
-    m_world_sim.m_deletion_indices_queue.clear();
+    m_batch_ptr->update_range(m_begin, m_end);
     return 0;
 }
 
-int32_t World_simulation::J4_add_pending_objs_job::execute()
+int32_t World_simulation::J3_remove_pending_objs_job::execute()
 {
-    std::lock_guard<std::mutex> lock1{ m_world_sim.m_insertion_queue_mutex };
-    std::lock_guard<std::mutex> lock2{ m_world_sim.m_entity_pool_mutex };
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_REMOVE_PENDING_OBJS, "J3 remove pending objs");
 
-    uint32_t pool_idx_iter_pos{ 0 };
-    for (auto& sim_entity_uptr : m_world_sim.m_insertion_queue)
-    {
-        bool inserted{ false };
-        for (size_t i = 0; i < k_num_max_entities; i++)
-        if (m_world_sim.m_entity_pool[i] == nullptr)
+    std::lock_guard<std::mutex> lock{ m_world_sim.m_entity_pool_mutex };
+    m_world_sim.m_deletion_keys_queue.drain([&](entity_key_t&& key) {
+        uint32_t idx, version_num;
+        pool::elem_key_extract_data(key, idx, version_num);
+
+        if (idx >= k_num_max_entities)
         {
-            // Insert.
-            m_world_sim.m_entity_pool[i] = std::move(sim_entity_uptr);
-            m_world_sim.m_entity_pool[i]->on_create(m_world_sim, i);
-            inserted = true;
-            break;
+            assert(false);
+            return;
         }
 
-        if (!inserted)
+        auto& slot{ m_world_sim.m_entity_pool[idx] };
+        if (slot.entity == nullptr || slot.version != version_num)
         {
+            // Stale key (entity already removed).
+            return;
+        }
+
+        slot.entity->on_teardown(m_world_sim);
+        slot.entity = nullptr;
+
+        // Return slot to free list.
+        slot.next_free_idx = m_world_sim.m_entity_pool_free_head;
+        m_world_sim.m_entity_pool_free_head = idx;
+    });
+
+    return 0;
+}
+
+int32_t World_simulation::J4_add_pending_objs_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_ADD_PENDING_OBJS, "J4 add pending objs");
+
+    std::lock_guard<std::mutex> lock{ m_world_sim.m_entity_pool_mutex };
+    m_world_sim.m_insertion_queue.drain([&](std::unique_ptr<simulating::Entity_ifc>&& sim_entity_uptr) {
+        uint32_t idx{ m_world_sim.m_entity_pool_free_head };
+        if (idx == k_no_free_entity_idx)
+        {
+            // @NOTE: Entity gets dropped.
             std::cerr << "ERROR: Inserting sim entity failed." << std::endl;
             assert(false);
-            break;
+            return;
         }
-    }
-    // if (!m_world_sim.m_insertion_queue.empty())
-    //     m_world_sim.m_rebuild_entity_list = true;
 
-    m_world_sim.m_insertion_queue.clear();
+        // Pop slot off free list.
+        auto& slot{ m_world_sim.m_entity_pool[idx] };
+        m_world_sim.m_entity_pool_free_head = slot.next_free_idx;
+        slot.next_free_idx = k_no_free_entity_idx;
+
+        // Insert.
+        slot.version++;
+        slot.entity = std::move(sim_entity_uptr);
+        slot.entity->on_create(m_world_sim, pool::create_elem_key(idx, slot.version));
+    });
+
+    // Commit all the bodies spawned this tick.
+    phys_obj::add_pending_bodies();
+    return 0;
+}
+
+int32_t World_simulation::J5_step_physics_world_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_STEP_PHYSICS, "J5 step physics world");
+
+    // @NOTE: Runs once per tick after all the behavior groups have finished,
+    //   so the physics inputs written by the behaviors are all visible here.
+    m_world_sim.update_physics_system();
+    return 0;
+}
+
+int32_t World_simulation::J8_dispatch_contact_events_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_DISPATCH_CONTACT_EVENTS, "J8 dispatch contact events");
+
+    phys_obj::dispatch_contact_events(m_begin, m_end);
+    return 0;
+}
+
+int32_t World_simulation::J9_update_triggers_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_UPDATE_TRIGGERS, "J9 update triggers");
+
+    phys_obj::update_triggers(m_begin, m_end);
+    return 0;
+}
+
+int32_t World_simulation::J10_query_hurtboxes_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_COMBAT, "J10 query hurtboxes");
+
+    phys_obj::query_active_hurtboxes(m_begin, m_end);
+    return 0;
+}
+
+int32_t World_simulation::J11_report_combat_hits_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_COMBAT, "J11 report combat hits");
+
+    phys_obj::report_combat_hits();
+    return 0;
+}
+
+int32_t World_simulation::J12_run_scene_queries_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_SCENE_QUERIES, "J12 run scene queries");
+
+    phys_obj::run_scene_queries(m_begin, m_end);
+    return 0;
+}
+
+int32_t World_simulation::J13_collect_contact_events_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_DISPATCH_CONTACT_EVENTS, "J13 collect contact events");
+
+    m_world_sim.m_num_contact_receivers = phys_obj::collect_contact_events();
+    return 0;
+}
+
+int32_t World_simulation::J14_find_combat_candidates_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_COMBAT, "J14 find combat candidates");
+
+    phys_obj::find_combat_candidates();
+    return 0;
+}
+
+int32_t World_simulation::J6_propagate_transforms_job::execute()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_PROPAGATE_TRANSFORMS, "J6 propagate transforms");
+
+    phys_obj::update_moved_transform_holders(m_begin, m_end);
     return 0;
 }
 
@@ -150,12 +426,32 @@ int32_t World_simulation::J4_add_pending_objs_job::execute()
 // Job source callback.
 Job_source::Job_next_jobs_return_data World_simulation::fetch_next_jobs_callback()
 {
-    Job_next_jobs_return_data return_data;
+    static constexpr const char* k_state_scope_names[]{
+        "fetch_next_jobs_callback: SETUP_PHYSICS_WORLD",
+        "fetch_next_jobs_callback: WAIT_FOR_GLOBAL_SETUP_COMPLETION",
+        "fetch_next_jobs_callback: WAIT_UNTIL_TIMEOUT",
+        "fetch_next_jobs_callback: EXECUTE_LOGIC_UPDATE",
+        "fetch_next_jobs_callback: STEP_PHYSICS_WORLD",
+        "fetch_next_jobs_callback: FIND_COMBAT_CANDIDATES",
+        "fetch_next_jobs_callback: RUN_PHYSICS_QUERIES",
+        "fetch_next_jobs_callback: REPORT_COMBAT_HITS",
+        "fetch_next_jobs_callback: DISPATCH_CONTACT_EVENTS",
+        "fetch_next_jobs_callback: PROPAGATE_TRANSFORMS",
+        "fetch_next_jobs_callback: REMOVE_PENDING_SIM_OBJS",
+        "fetch_next_jobs_callback: ADD_PENDING_SIM_OBJS",
+        "fetch_next_jobs_callback: CHECK_FOR_SHUTDOWN_REQUEST",
+    };
+    static_assert(std::size(k_state_scope_names) ==
+                  static_cast<size_t>(Job_source_state::NUM_STATES));
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_SCHEDULING,
+                               k_state_scope_names[static_cast<uint32_t>(m_current_state.load())]);
+
+    m_next_jobs.clear();
 
     switch (m_current_state)
     {
         case Job_source_state::SETUP_PHYSICS_WORLD:
-            return_data.jobs.emplace_back(m_s1_create_jolt_physics_world.get());
+            m_next_jobs.emplace_back(m_s1_create_jolt_physics_world.get());
             m_current_state = Job_source_state::WAIT_FOR_GLOBAL_SETUP_COMPLETION;
             break;
 
@@ -182,7 +478,9 @@ Job_source::Job_next_jobs_return_data World_simulation::fetch_next_jobs_callback
         case Job_source_state::WAIT_UNTIL_TIMEOUT:
             //if ()  @TODO: add stop doing stuff condition here.
             // else
-            if (m_timekeeper.check_timeout_and_reset())
+            // @NOTE: In `WAIT_MODE_SLEEP_SPIN` this parks the calling worker
+            //   until the tick deadline (sleep, then spin).
+            if (m_tick_pacer.wait_for_next_tick())
             {
                 m_current_state = Job_source_state::EXECUTE_LOGIC_UPDATE;
             }
@@ -190,28 +488,78 @@ Job_source::Job_next_jobs_return_data World_simulation::fetch_next_jobs_callback
 
         case Job_source_state::EXECUTE_LOGIC_UPDATE:
         {
-            std::lock_guard<std::mutex> lock{ m_behavior_pool_mutex };
+            // Commit behavior data written last tick.
+            simulating::Behavior_data_w_version::flip_tick_epoch();
+            tick_profiler::set_current_tick(++m_tick_count);
+            phys_obj::set_tick_delta_time(m_tick_pacer.get_tick_delta_time());
 
-            size_t num_behavior_grps{ m_behavior_pool.size() };
-            size_t old_execute_grps{ m_j2_execute_simulation_tick_jobs.size() };
-            if (num_behavior_grps > m_j2_execute_simulation_tick_jobs.size())
+            // Apply the behavior group edits queued since last tick.
+            if (apply_pending_behavior_group_edits())
+            {
+                m_behavior_schedule_dirty = true;
+            }
+            {
+                // @NOTE: The batched behaviors aren't part of the schedule.
+                std::lock_guard<std::mutex> lock{ m_behavior_batches_mutex };
+                for (auto& batch : m_behavior_batches)
+                {
+                    if (batch != nullptr)
+                    {
+                        batch->apply_pending_edits();
+                    }
+                }
+            }
+
+            if (m_behavior_schedule_dirty)
+            {
+                rebuild_behavior_schedule();
+                m_behavior_schedule_dirty = false;
+            }
+            else if (m_behavior_costs_measured)
+            {
+                partition_behavior_schedule();
+            }
+            m_measuring_behavior_costs = (m_tick_count % k_behavior_cost_sample_interval == 0);
+            m_behavior_costs_measured = m_measuring_behavior_costs;
+
+            // Behavior schedule, alongside the batched behaviors.
+            emit_behavior_jobs(m_next_jobs);
+
+            // Split the batched behaviors into chunks.
+            // @NOTE: The J7 pool has `m_max_range_jobs` jobs plus one per
+            //   batch type, so growing the chunks until the total behaviors
+            //   fit in `m_max_range_jobs` of them always leaves enough jobs
+            //   for the partial chunk at the end of each batch.
+            std::lock_guard<std::mutex> lock{ m_behavior_batches_mutex };
+            size_t total_behaviors{ 0 };
+            for (auto& batch : m_behavior_batches)
             {
-                m_j2_execute_simulation_tick_jobs.reserve(num_behavior_grps);
-                while (m_j2_execute_simulation_tick_jobs.size() < num_behavior_grps)
+                if (batch != nullptr)
                 {
-                    m_j2_execute_simulation_tick_jobs.emplace_back(
-                        std::make_unique<J2_execute_simulation_tick_job>(*this));
+                    total_behaviors += batch->get_num_behaviors();
                 }
             }
+            size_t chunk_size{
+                std::max(k_behavior_batch_chunk_size,
+                         (total_behaviors + m_max_range_jobs - 1) / m_max_range_jobs) };
 
-            return_data.jobs.reserve(num_behavior_grps);
-            size_t i{ 0 };
-            for (auto& behavior_group : m_behavior_pool)
+            size_t num_chunks{ 0 };
+            for (auto& batch : m_behavior_batches)
             {
-                m_j2_execute_simulation_tick_jobs[i]
-                    ->set_behavior_group(&behavior_group.second);
-                return_data.jobs.emplace_back(m_j2_execute_simulation_tick_jobs[i].get());
-                i++;
+                if (batch == nullptr)
+                {
+                    continue;
+                }
+
+                size_t num_behaviors{ batch->get_num_behaviors() };
+                for (size_t begin = 0; begin < num_behaviors; begin += chunk_size)
+                {
+                    assert(num_chunks < m_j7_execute_behavior_batch_jobs.size());
+                    size_t end{ std::min(begin + chunk_size, num_behaviors) };
+                    m_j7_execute_behavior_batch_jobs[num_chunks]->set_range(batch.get(), begin, end);
+                    m_next_jobs.emplace_back(m_j7_execute_behavior_batch_jobs[num_chunks].get());
+                    num_chunks++;
+                }
             }
 
             m_current_state = Job_source_state::STEP_PHYSICS_WORLD;
@@ -219,20 +567,113 @@ Job_source::Job_next_jobs_return_data World_simulation::fetch_next_jobs_callback
         break;
 
         case Job_source_state::STEP_PHYSICS_WORLD:
+            m_next_jobs.emplace_back(m_j5_step_physics_world_job.get());
+            m_current_state = Job_source_state::FIND_COMBAT_CANDIDATES;
+            break;
+
+        case Job_source_state::FIND_COMBAT_CANDIDATES:
+            // Find the hitboxes near the active hurtboxes (queried next state).
+            m_num_active_hurtboxes = phys_obj::collect_active_hurtboxes();
+            if (m_num_active_hurtboxes > 0)
+            {
+                m_next_jobs.emplace_back(m_j14_find_combat_candidates_job.get());
+            }
+
+            // Meanwhile, sort the contact events recorded during the step by
+            // receiver (nothing records them outside of the step).
+            m_next_jobs.emplace_back(m_j13_collect_contact_events_job.get());
+
+            m_current_state = Job_source_state::RUN_PHYSICS_QUERIES;
+            break;
+
+        case Job_source_state::RUN_PHYSICS_QUERIES:
+        {
+            // Update the triggers against the stepped world.
+            size_t num_triggers{ phys_obj::get_num_triggers() };
+            emit_range_jobs(m_j9_update_triggers_jobs,
+                            num_triggers,
+                            k_trigger_update_batch_size,
+                            m_next_jobs);
+
+            // Query the hurtboxes alongside. Their hits get reported in the
+            // next state, once all the queries are done.
+            emit_range_jobs(m_j10_query_hurtboxes_jobs,
+                            m_num_active_hurtboxes,
+                            k_hurtbox_query_batch_size,
+                            m_next_jobs);
+
+            // And the scene queries that the behaviors submitted this tick
+            // (read back next tick).
+            size_t num_scene_queries{ phys_obj::collect_scene_queries() };
+            emit_range_jobs(m_j12_run_scene_queries_jobs,
+                            num_scene_queries,
+                            k_scene_query_batch_size,
+                            m_next_jobs);
+
+            m_current_state = Job_source_state::REPORT_COMBAT_HITS;
+            break;
+        }
+
+        case Job_source_state::REPORT_COMBAT_HITS:
+            if (m_num_active_hurtboxes > 0)
+            {
+                m_next_jobs.emplace_back(m_j11_report_combat_hits_job.get());
+            }
+            m_current_state = Job_source_state::DISPATCH_CONTACT_EVENTS;
+            break;
+
+        case Job_source_state::DISPATCH_CONTACT_EVENTS:
+        {
+            // Deliver the contact events collected by J13 in parallel.
+            // @NOTE: Only once the queries above are done, since receivers
+            //   may move their bodies (see `Contact_receiver_ifc`).
+            emit_range_jobs(m_j8_dispatch_contact_events_jobs,
+                            m_num_contact_receivers,
+                            k_contact_dispatch_batch_size,
+                            m_next_jobs);
+
+            m_current_state = Job_source_state::PROPAGATE_TRANSFORMS;
+            break;
+        }
+
+        case Job_source_state::PROPAGATE_TRANSFORMS:
+        {
+            // Propagate new simulated positions to transform holders (only
+            // the ones that moved).
+            size_t num_holders{ phys_obj::collect_moved_transform_holders() };
+            emit_range_jobs(m_j6_propagate_transforms_jobs,
+                            num_holders,
+                            k_transform_propagation_batch_size,
+                            m_next_jobs);
 
             m_current_state = Job_source_state::REMOVE_PENDING_SIM_OBJS;
             break;
+        }
 
         case Job_source_state::REMOVE_PENDING_SIM_OBJS:
-            return_data.jobs.emplace_back(m_j3_remove_pending_objs_job.get());
+            // Publish the propagated transforms (all J6 jobs have finished).
+            phys_obj::Transform_holder::increment_buffer_offset();
+            m_tick_pacer.mark_tick_published();
+
+            m_next_jobs.emplace_back(m_j3_remove_pending_objs_job.get());
             m_current_state = Job_source_state::ADD_PENDING_SIM_OBJS;
             break;
 
         case Job_source_state::ADD_PENDING_SIM_OBJS:
-            return_data.jobs.emplace_back(m_j4_add_pending_objs_job.get());
+            m_next_jobs.emplace_back(m_j4_add_pending_objs_job.get());
             m_current_state = Job_source_state::WAIT_UNTIL_TIMEOUT;
             break;
     }
 
+    // Hand the job list over to the job system.
+    // @NOTE: The engine's `Job_next_jobs_return_data` owns its job list, so
+    //   this is the one allocation left on the tick path (exempt from the
+    //   zero-allocation check, since the job system owns the list after this).
+    Job_next_jobs_return_data return_data;
+    if (!m_next_jobs.empty())
+    {
+        HAWSOO_ALLOC_COUNTER_EXEMPT_SCOPE();
+        return_data.jobs.assign(m_next_jobs.begin(), m_next_jobs.end());
+    }
     return return_data;
 }
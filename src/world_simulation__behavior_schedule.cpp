@@ -0,0 +1,138 @@
+#include "world_simulation.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>  // std::greater
+#include <unordered_map>
+#include <utility>
+#include "simulating_ifc.h"
+#include "tick_profiler.h"
+
+
+void World_simulation::rebuild_behavior_schedule()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_SCHEDULING, "Rebuild behavior schedule");
+
+    // Keep the measured costs of the behaviors that are still around.
+    std::unordered_map<simulating::Behavior_ifc*, float_t> prev_costs;
+    prev_costs.reserve(m_behavior_schedule_nodes.size());
+    for (size_t i = 0; i < m_behavior_schedule_nodes.size(); i++)
+    {
+        prev_costs.emplace(m_behavior_schedule_nodes[i], m_behavior_schedule_costs[i]);
+    }
+
+    // Gather behaviors of all groups.
+    m_behavior_schedule_nodes.clear();
+    for (auto& behavior_group : m_behavior_groups)
+    {
+        for (auto& behavior : behavior_group)
+        {
+            m_behavior_schedule_nodes.emplace_back(behavior.get());
+        }
+    }
+    size_t num_nodes{ m_behavior_schedule_nodes.size() };
+
+    m_behavior_schedule_costs.resize(num_nodes);
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        auto it{ prev_costs.find(m_behavior_schedule_nodes[i]) };
+        m_behavior_schedule_costs[i] = (it != prev_costs.end() ? it->second : -1.0f);
+    }
+
+    partition_behavior_schedule();
+}
+
+void World_simulation::partition_behavior_schedule()
+{
+    HAWSOO_TICK_PROFILER_SCOPE(tick_profiler::PHASE_SCHEDULING, "Partition behavior schedule");
+
+    m_behavior_schedule_job_ends.clear();
+
+    size_t num_nodes{ m_behavior_schedule_nodes.size() };
+    if (num_nodes == 0)
+    {
+        return;
+    }
+
+    size_t max_jobs{
+        std::max<size_t>(1, static_cast<size_t>(m_num_threads) * k_behavior_jobs_per_thread) };
+
+    auto& sorted_nodes{ m_behavior_partition_scratch.sorted_nodes };
+    auto& job_loads{ m_behavior_partition_scratch.job_loads };
+    auto& node_jobs{ m_behavior_partition_scratch.node_jobs };
+    auto& job_offsets{ m_behavior_partition_scratch.job_offsets };
+    auto& packed_nodes{ m_behavior_partition_scratch.packed_nodes };
+    auto& packed_costs{ m_behavior_partition_scratch.packed_costs };
+
+    // Longest processing time first.
+    sorted_nodes.clear();
+    float_t total_cost{ 0.0f };
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        float_t cost{ m_behavior_schedule_costs[i] < 0.0f ?
+                          k_default_behavior_cost_ns :
+                          m_behavior_schedule_costs[i] };
+        sorted_nodes.emplace_back(cost, i);
+        total_cost += cost;
+    }
+    std::sort(sorted_nodes.begin(), sorted_nodes.end(), std::greater<>());
+
+    // Don't split cheap ticks into jobs that cost less than scheduling them.
+    size_t num_jobs{ static_cast<size_t>(std::ceil(total_cost / k_min_behavior_job_cost_ns)) };
+    num_jobs = std::clamp<size_t>(num_jobs, 1, std::min(max_jobs, num_nodes));
+
+    // Put each behavior into the job with the least cost so far.
+    job_loads.clear();
+    for (size_t j = 0; j < num_jobs; j++)
+    {
+        job_loads.emplace_back(0.0f, j);
+    }
+    node_jobs.resize(num_nodes);
+    for (auto& [cost, node_idx] : sorted_nodes)
+    {
+        std::pop_heap(job_loads.begin(), job_loads.end(), std::greater<>());
+        job_loads.back().first += cost;
+        node_jobs[node_idx] = job_loads.back().second;
+        std::push_heap(job_loads.begin(), job_loads.end(), std::greater<>());
+    }
+
+    // Make each job's behaviors contiguous (stable, so the group order
+    // within a job is kept).
+    job_offsets.assign(num_jobs + 1, 0);
+    for (size_t job_idx : node_jobs)
+    {
+        job_offsets[job_idx + 1]++;
+    }
+    for (size_t j = 0; j < num_jobs; j++)
+    {
+        job_offsets[j + 1] += job_offsets[j];
+        m_behavior_schedule_job_ends.emplace_back(job_offsets[j + 1]);
+    }
+
+    packed_nodes.resize(num_nodes);
+    packed_costs.resize(num_nodes);
+    for (size_t i = 0; i < num_nodes; i++)
+    {
+        size_t dst{ job_offsets[node_jobs[i]]++ };
+        packed_nodes[dst] = m_behavior_schedule_nodes[i];
+        packed_costs[dst] = m_behavior_schedule_costs[i];
+    }
+    std::swap(packed_nodes, m_behavior_schedule_nodes);
+    std::swap(packed_costs, m_behavior_schedule_costs);
+}
+
+void World_simulation::emit_behavior_jobs(std::vector<Job_ifc*>& out_jobs)
+{
+    // @NOTE: The J2 pool covers the most jobs that partitioning makes.
+    size_t num_jobs{ m_behavior_schedule_job_ends.size() };
+    assert(num_jobs <= m_j2_execute_simulation_tick_jobs.size());
+
+    for (size_t i = 0; i < num_jobs; i++)
+    {
+        size_t begin{ i == 0 ? 0 : m_behavior_schedule_job_ends[i - 1] };
+        size_t end{ m_behavior_schedule_job_ends[i] };
+        m_j2_execute_simulation_tick_jobs[i]->set_range(begin, end, m_measuring_behavior_costs);
+        out_jobs.emplace_back(m_j2_execute_simulation_tick_jobs[i].get());
+    }
+}
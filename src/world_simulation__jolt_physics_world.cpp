@@ -1,7 +1,8 @@
 #include "world_simulation.h"
 
-#define HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM 0
+#define HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM 1
 
+#include <algorithm>  // std::min
 #include <atomic>
 #include <cassert>
 #include <memory>  // std::unique_ptr
@@ -27,7 +28,7 @@ static std::atomic_bool s_is_initialized{ false };
 static std::unique_ptr<JPH::Factory> s_jolt_factory;
 static std::unique_ptr<JPH::TempAllocatorImpl> s_jolt_temp_allocator;
 #if HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM
-static std::unique_ptr<Job_system_integration> s_job_system_integration;
+static Job_system_integration s_job_system_integration;  // @NOTE: Initialized in `S1_create_jolt_physics_world`.
 #endif  // HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM
 static std::unique_ptr<JPH::JobSystemSingleThreaded> s_job_system_single_threaded;
 static JPH::JobSystem* s_using_job_system_ptr{ nullptr };
@@ -42,6 +43,15 @@ static My_contact_listener s_contact_listener;
 }  // namespace
 
 
+Job_source* World_simulation::get_physics_job_source()
+{
+#if HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM
+    return &s_job_system_integration;
+#else
+    return nullptr;
+#endif  // HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM
+}
+
 // Jobs.
 int32_t World_simulation::S1_create_jolt_physics_world::execute()
 {
@@ -65,8 +75,8 @@ int32_t World_simulation::S1_create_jolt_physics_world::execute()
 
     s_jolt_temp_allocator = std::make_unique<JPH::TempAllocatorImpl>(10 * 1024 * 1024);
 
-    constexpr uint32_t k_max_physics_jobs{ 2048 };
-    constexpr uint32_t k_max_physics_barriers{ 8 };
+    constexpr uint32_t k_max_physics_jobs{ JPH::cMaxPhysicsJobs };
+    constexpr uint32_t k_max_physics_barriers{ JPH::cMaxPhysicsBarriers };
     constexpr int32_t k_max_concurrency{ 16 };  // @NOTE: The point at which Jolt physics' multithreaded performance starts to degrade (w/ current version).  -Thea 2025/03/13
 
 #if HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM
@@ -76,21 +86,18 @@ int32_t World_simulation::S1_create_jolt_physics_world::execute()
             k_max_concurrency) };
     if (concurrency > 1)
     {
-        // @TODO: IMPLEMENT THE MULTITHREADED JOB SYSTEM INTO THE ENGINE JOB SYSTEM!!!!
-        s_job_system_integration =
-            std::make_unique<Job_system_integration>(k_max_physics_jobs,
-                                                     k_max_physics_barriers,
-                                                     concurrency);
-        s_using_job_system_ptr = s_job_system_integration.get();
+        s_job_system_integration.init(k_max_physics_jobs,
+                                      k_max_physics_barriers,
+                                      concurrency);
+        s_using_job_system_ptr = &s_job_system_integration;
     }
     else
-#else
+#endif  // HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM
     {
         s_job_system_single_threaded =
             std::make_unique<JPH::JobSystemSingleThreaded>(k_max_physics_jobs);
         s_using_job_system_ptr = s_job_system_single_threaded.get();
     }
-#endif  // HAWSOO_USE_JOLT_MULTITHREADED_JOB_SYSTEM
 
     assert(s_using_job_system_ptr != nullptr);
 
@@ -98,7 +105,6 @@ int32_t World_simulation::S1_create_jolt_physics_world::execute()
     auto& phys_sys{ m_world_sim.m_physics_system };
     phys_sys = std::make_unique<JPH::PhysicsSystem>();
 
-    constexpr uint32_t k_max_bodies{ 65536 };
     constexpr uint32_t k_num_body_mutexes{ 0 };  // Default settings is no mutexes to protect bodies from concurrent access.
     constexpr uint32_t k_max_body_pairs{ 65536 };
     constexpr uint32_t k_max_contact_constraints{ 10240 };
@@ -117,7 +123,10 @@ int32_t World_simulation::S1_create_jolt_physics_world::execute()
 
     phys_sys->OptimizeBroadPhase();
 
-    phys_obj::set_references(phys_sys.get(), &phys_sys->GetBodyInterface(), s_using_job_system_ptr);
+    phys_obj::set_references(phys_sys.get(),
+                             &phys_sys->GetBodyInterface(),
+                             s_using_job_system_ptr,
+                             m_num_threads);
 
     return 0;
 }
@@ -127,8 +136,8 @@ bool World_simulation::update_physics_system()
 {
     // @THOUGHTS: Perhaps the reason why there's an error here is bc the move constructor is making copies of the physics objects???
     JPH::EPhysicsUpdateError error =
-        m_physics_system->Update(k_world_sim_delta_time,
-                                 1,
+        m_physics_system->Update(m_tick_pacer.get_tick_delta_time(),
+                                 static_cast<int32_t>(m_tick_pacer.get_physics_substeps()),
                                  s_jolt_temp_allocator.get(),
                                  s_using_job_system_ptr);
 
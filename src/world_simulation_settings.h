@@ -1,5 +1,10 @@
 #pragma once
+#include <cinttypes>
 #include <cmath>
 
+// Defaults (runtime configurable through `World_simulation::get_tick_pacer()`).
 constexpr uint32_t k_world_sim_hz{ 50 };
-constexpr float_t k_world_sim_delta_time{ 1.0f / k_world_sim_hz };
+constexpr uint32_t k_world_sim_physics_substeps{ 1 };
+constexpr uint32_t k_world_sim_max_catch_up_ticks{ 2 };
+
+constexpr uint32_t k_max_bodies{ 65536 };
@@ -0,0 +1,110 @@
+// Multi-producer stress test for `world_sim::Mpsc_queue`.
+// Producers push (producer idx, sequence number) pairs while the consumer
+// drains concurrently. Every item has to come out exactly once, and the
+// items of each producer have to come out in push order.
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "mpsc_queue.h"
+
+
+namespace
+{
+
+constexpr uint32_t k_num_producers{ 8 };
+constexpr uint32_t k_num_items_per_producer{ 200000 };
+
+struct Item
+{
+    uint32_t producer_idx;
+    uint32_t sequence;
+};
+
+void run_producer(world_sim::Mpsc_queue<Item>& queue,
+                  std::atomic_bool& start_flag,
+                  uint32_t producer_idx)
+{
+    while (!start_flag.load(std::memory_order_acquire))
+    {
+        std::this_thread::yield();
+    }
+
+    for (uint32_t i = 0; i < k_num_items_per_producer; i++)
+    {
+        queue.push({ producer_idx, i });
+    }
+}
+
+}  // namespace
+
+
+int main()
+{
+    world_sim::Mpsc_queue<Item> queue;
+    std::atomic_bool start_flag{ false };
+
+    std::vector<std::thread> producers;
+    producers.reserve(k_num_producers);
+    for (uint32_t i = 0; i < k_num_producers; i++)
+    {
+        producers.emplace_back(run_producer, std::ref(queue), std::ref(start_flag), i);
+    }
+
+    // Drain concurrently with the producers.
+    std::vector<uint32_t> next_sequences(k_num_producers, 0);
+    uint64_t num_received{ 0 };
+    uint64_t num_out_of_order{ 0 };
+    auto check_item{ [&](Item&& item) {
+        if (item.producer_idx >= k_num_producers ||
+            item.sequence != next_sequences[item.producer_idx])
+        {
+            num_out_of_order++;
+        }
+        else
+        {
+            next_sequences[item.producer_idx]++;
+        }
+        num_received++;
+    } };
+
+    start_flag.store(true, std::memory_order_release);
+    constexpr uint64_t k_num_items_total{
+        static_cast<uint64_t>(k_num_producers) * k_num_items_per_producer };
+    while (num_received < k_num_items_total && num_out_of_order == 0)
+    {
+        if (queue.drain(check_item) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    // Nothing should be left over.
+    size_t num_left_over{ queue.drain(check_item) };
+
+    bool failed{ num_out_of_order > 0 || num_left_over > 0 || num_received != k_num_items_total };
+    for (uint32_t i = 0; i < k_num_producers; i++)
+    {
+        failed |= (next_sequences[i] != k_num_items_per_producer);
+    }
+
+    std::printf("received: %llu/%llu, out of order: %llu, left over: %zu\n",
+                static_cast<unsigned long long>(num_received),
+                static_cast<unsigned long long>(k_num_items_total),
+                static_cast<unsigned long long>(num_out_of_order),
+                num_left_over);
+    if (failed)
+    {
+        std::printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}